@@ -0,0 +1,58 @@
+/* The limb codec in nlx402.c against the textbook digit-at-a-time one, on
+ * the shapes the SDK decodes: 32-byte keys and 64-byte signatures. */
+#include "../nlx402.c"
+#include "../tests/base58_ref.h"
+#include "bench.h"
+
+typedef struct {
+    unsigned char bytes[NLX402_BASE58_MAX_BYTES];
+    size_t len;
+    char text[100];
+    size_t text_len;
+} Case;
+
+static void sdk_decode(void *p) {
+    Case *c = (Case *)p;
+    unsigned char out[NLX402_BASE58_MAX_BYTES];
+    bench_sink += (unsigned long long)nlx402_base58_decode(c->text, c->text_len, out, c->len) + out[0];
+}
+
+static void ref_decode(void *p) {
+    Case *c = (Case *)p;
+    unsigned char out[NLX402_BASE58_MAX_BYTES];
+    bench_sink += (unsigned long long)ref_base58_decode(c->text, c->text_len, out, c->len) + out[0];
+}
+
+static void sdk_encode(void *p) {
+    Case *c = (Case *)p;
+    char out[100];
+    bench_sink += nlx402_base58_encode(c->bytes, c->len, out, sizeof(out));
+}
+
+static void ref_encode(void *p) {
+    Case *c = (Case *)p;
+    char out[100];
+    bench_sink += ref_base58_encode(c->bytes, c->len, out, sizeof(out));
+}
+
+int main(void) {
+    Case cases[2];
+    cases[0].len = NLX402_PUBKEY_BYTES;
+    cases[1].len = NLX402_SIGNATURE_BYTES;
+    for (int k = 0; k < 2; k++) {
+        for (size_t i = 0; i < cases[k].len; i++) cases[k].bytes[i] = (unsigned char)(i * 151 + 7 * k + 3);
+        cases[k].text_len = nlx402_base58_encode(cases[k].bytes, cases[k].len, cases[k].text, sizeof(cases[k].text));
+    }
+
+    const char *names[2] = { "32-byte key", "64-byte signature" };
+    for (int k = 0; k < 2; k++) {
+        printf("%s (%zu chars)\n", names[k], cases[k].text_len);
+        double ref = bench_run("decode, naive", ref_decode, &cases[k]);
+        double sdk = bench_run("decode, nlx402", sdk_decode, &cases[k]);
+        printf("  %-40s %10.1fx\n", "decode speedup", ref / sdk);
+        ref = bench_run("encode, naive", ref_encode, &cases[k]);
+        sdk = bench_run("encode, nlx402", sdk_encode, &cases[k]);
+        printf("  %-40s %10.1fx\n", "encode speedup", ref / sdk);
+    }
+    return 0;
+}
@@ -0,0 +1,36 @@
+/* Minimal timing for the benchmarks: each case runs in batches until it
+ * has taken at least BENCH_SECONDS and reports nanoseconds per call. */
+#ifndef NLX402_BENCH_H
+#define NLX402_BENCH_H
+
+#include <stdio.h>
+#include <time.h>
+
+#define BENCH_SECONDS 0.3
+
+/* Results go here so the compiler cannot drop the work. */
+static volatile unsigned long long bench_sink;
+
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static double bench_run(const char *label, void (*fn)(void *), void *arg) {
+    unsigned long long calls = 0;
+    unsigned long long batch = 16;
+    double start = bench_now();
+    double elapsed;
+    do {
+        for (unsigned long long i = 0; i < batch; i++) fn(arg);
+        calls += batch;
+        if (batch < (1ULL << 20)) batch *= 2;
+        elapsed = bench_now() - start;
+    } while (elapsed < BENCH_SECONDS);
+    double ns = elapsed * 1e9 / (double)calls;
+    printf("  %-40s %10.1f ns/op\n", label, ns);
+    return ns;
+}
+
+#endif
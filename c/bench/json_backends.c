@@ -0,0 +1,100 @@
+/* Response parsing with whichever JSON backend this was built with: the
+ * built-in reader (default), cJSON (-DNLX402_JSON_CJSON) or yyjson
+ * (-DNLX402_JSON_YYJSON). `make bench-backends` builds and runs all three.
+ * Each case parses one mock fixture into its response struct and frees it,
+ * from a fresh copy of the body since yyjson parses in place. */
+#include "../nlx402.c"
+#include "../tests/mock.h"
+#include "bench.h"
+
+#if defined(NLX402_JSON_YYJSON)
+#define BACKEND "yyjson"
+#elif defined(NLX402_JSON_CJSON)
+#define BACKEND "cjson"
+#else
+#define BACKEND "builtin"
+#endif
+
+typedef struct {
+    const char *name;
+    const ResponseSchema *schema;
+    char body[8192];
+    size_t len;
+    char buf[8192 + 64];
+    union {
+        MetadataResponse metadata;
+        AuthMeResponse auth_me;
+        QuoteResponse quote;
+        PaidAccessResponse paid;
+    } out;
+} Case;
+
+static Nlx402Client client;
+static int errors;
+
+static void parse(void *arg) {
+    Case *c = (Case *)arg;
+    memcpy(c->buf, c->body, c->len);
+    memset(c->buf + c->len, 0, JSON_PADDING);
+    Nlx402Handle h = { 0 };
+    h.recv = c->buf;
+    h.recv_size = c->len;
+    h.recv_cap = c->len + JSON_PADDING;
+    h.allocator = &client.allocator;
+
+    ResponseParse r;
+    JsonParser p;
+    response_parse_init(&r, c->schema, &client, &c->out, &client.allocator);
+    json_init(&p, &response_shape, &r);
+    int rc = JSON_STREAMING ? json_feed(&p, c->buf, c->len) : 0;
+    if (rc == 0) rc = json_read_finish(&p, &h, &client.allocator);
+    if (rc != 0) errors++;
+    bench_sink += (unsigned long long)r.fits;
+    response_free(c->schema, &c->out);
+}
+
+int main(void) {
+    nlx402_client_init(&client, "http://127.0.0.1:1", "bench-key");
+    static Case cases[5];
+    cases[0].name = "metadata";
+    cases[0].schema = &metadata_schema;
+    cases[0].len = mock_fixture(MOCK_METADATA, NULL, NULL, cases[0].body, sizeof(cases[0].body));
+    cases[1].name = "auth/me";
+    cases[1].schema = &auth_me_schema;
+    cases[1].len = mock_fixture(MOCK_AUTH_ME, NULL, NULL, cases[1].body, sizeof(cases[1].body));
+    cases[2].name = "quote";
+    cases[2].schema = &quote_schema;
+    cases[2].len = mock_fixture(MOCK_QUOTE, "0.5", NULL, cases[2].body, sizeof(cases[2].body));
+    cases[3].name = "paid access";
+    cases[3].schema = &paid_access_schema;
+    cases[3].len = mock_fixture(MOCK_PAID_ACCESS, NULL, NULL, cases[3].body, sizeof(cases[3].body));
+
+    /* A metadata body with many mints and unknown members to skip. */
+    Case *big = &cases[4];
+    big->name = "metadata, 64 mints";
+    big->schema = &metadata_schema;
+    size_t n = (size_t)snprintf(big->body, sizeof(big->body), "{\"ok\":true,\"supported_mints\":[");
+    for (int i = 0; i < 64; i++) {
+        n += (size_t)snprintf(big->body + n, sizeof(big->body) - n, "%s\"Mint%02d%s\"", i ? "," : "", i % 8,
+                              "EPjFWdd5AufqSSqeM2qN1xzybapC8G4wEGGkZwyTDt1v");
+    }
+    n += (size_t)snprintf(big->body + n, sizeof(big->body) - n,
+                          "],\"extra\":{\"list\":[1,2,3,{\"deep\":[\"x\",\"y\"]}],\"note\":\"\\u00e9t\\u00e9\"},"
+                          "\"metadata\":{\"network\":\"mainnet\",\"version\":\"1.4.2\","
+                          "\"supported_chains\":[\"solana\",\"base\",\"ethereum\"]}}");
+    big->len = n;
+
+    printf("%s backend\n", BACKEND);
+    for (int k = 0; k < 5; k++) {
+        if (cases[k].len == 0) {
+            fprintf(stderr, "no fixture for %s\n", cases[k].name);
+            return 1;
+        }
+        char label[64];
+        snprintf(label, sizeof(label), "%s (%zu bytes)", cases[k].name, cases[k].len);
+        bench_run(label, parse, &cases[k]);
+    }
+    nlx402_client_cleanup(&client);
+    if (errors) fprintf(stderr, "%d parses failed\n", errors);
+    return errors == 0 ? 0 : 1;
+}
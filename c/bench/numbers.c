@@ -0,0 +1,86 @@
+/* The number reader and writers in nlx402.c against the strtod and printf
+ * calls they replace, on the kinds of values responses and prices carry. */
+#include "../nlx402.c"
+#include "bench.h"
+
+#define SAMPLES 64
+
+typedef struct {
+    char text[SAMPLES][32];
+    size_t len[SAMPLES];
+    double value[SAMPLES];
+} Case;
+
+static void sdk_parse(void *p) {
+    Case *c = (Case *)p;
+    double sum = 0, v;
+    for (int i = 0; i < SAMPLES; i++) {
+        if (json_number(c->text[i], c->len[i], &v) == 0) sum += v;
+    }
+    bench_sink += (unsigned long long)sum;
+}
+
+static void libc_parse(void *p) {
+    Case *c = (Case *)p;
+    double sum = 0;
+    for (int i = 0; i < SAMPLES; i++) sum += num_parse_slow(c->text[i], c->len[i], &c->value[i]) == 0 ? c->value[i] : 0;
+    bench_sink += (unsigned long long)sum;
+}
+
+static void sdk_format(void *p) {
+    Case *c = (Case *)p;
+    char buf[32];
+    for (int i = 0; i < SAMPLES; i++) bench_sink += (unsigned long long)json_format_number(c->value[i], buf, sizeof(buf));
+}
+
+static void libc_format(void *p) {
+    Case *c = (Case *)p;
+    char buf[32];
+    for (int i = 0; i < SAMPLES; i++) bench_sink += num_format_slow("%1.17g", c->value[i], buf, sizeof(buf));
+}
+
+static void sdk_price(void *p) {
+    Case *c = (Case *)p;
+    char buf[32];
+    for (int i = 0; i < SAMPLES; i++) bench_sink += num_format_price(c->value[i], buf, sizeof(buf));
+}
+
+static void libc_price(void *p) {
+    Case *c = (Case *)p;
+    char buf[32];
+    for (int i = 0; i < SAMPLES; i++) bench_sink += num_format_slow("%.8f", c->value[i], buf, sizeof(buf));
+}
+
+static void compare(const char *what, void (*libc)(void *), void (*sdk)(void *), Case *c) {
+    char label[64];
+    snprintf(label, sizeof(label), "%s, libc", what);
+    double ref = bench_run(label, libc, c);
+    snprintf(label, sizeof(label), "%s, nlx402", what);
+    double ours = bench_run(label, sdk, c);
+    printf("  %-40s %10.1fx\n", "speedup", ref / ours);
+}
+
+int main(void) {
+    /* Timestamps, decimals and prices, as they appear in responses. */
+    static Case wire;
+    for (int i = 0; i < SAMPLES; i++) {
+        switch (i % 4) {
+        case 0: snprintf(wire.text[i], sizeof(wire.text[i]), "%d", 1700000000 + i * 7919); break;
+        case 1: snprintf(wire.text[i], sizeof(wire.text[i]), "%d", i % 10); break;
+        case 2: snprintf(wire.text[i], sizeof(wire.text[i]), "0.%06d", i * 15013 % 1000000); break;
+        default: snprintf(wire.text[i], sizeof(wire.text[i]), "1.7%09de9", i * 104729); break;
+        }
+        wire.len[i] = strlen(wire.text[i]);
+        json_number(wire.text[i], wire.len[i], &wire.value[i]);
+    }
+    printf("response numbers (each op is %d of them)\n", SAMPLES);
+    compare("parse", libc_parse, sdk_parse, &wire);
+    compare("format", libc_format, sdk_format, &wire);
+
+    /* Prices callers pass to nlx402_get_quote. */
+    static Case prices;
+    for (int i = 0; i < SAMPLES; i++) prices.value[i] = (double)(i * 7 + 1) / (i % 3 ? 100.0 : 1e6);
+    printf("prices (each op is %d of them)\n", SAMPLES);
+    compare("format %.8f", libc_price, sdk_price, &prices);
+    return 0;
+}
@@ -1,37 +1,107 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <locale.h>
+#include <sys/mman.h>
 #include <curl/curl.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define CPU_X86 1
+#else
+#define CPU_X86 0
+#endif
+
+/* JSON backend, chosen at build time: the built-in streaming reader by
+ * default, or -DNLX402_JSON_CJSON / -DNLX402_JSON_YYJSON to parse through
+ * those libraries instead. Writing always uses the built-in writer. */
+#if defined(NLX402_JSON_YYJSON)
+#include <yyjson.h>
+#elif defined(NLX402_JSON_CJSON)
 #include <cjson/cJSON.h>
+#endif
+
+
+#define NLX402_ERR_BUFFER_TOO_SMALL (-2)
+#define NLX402_ERR_AMOUNT (-3)
+
+#define NLX402_PUBKEY_MAX 44
+#define NLX402_SIGNATURE_MAX 88
+#define NLX402_NONCE_MAX 64
+
+#define NLX402_PUBKEY_BYTES 32
+#define NLX402_SIGNATURE_BYTES 64
+#define NLX402_BASE58_MAX_BYTES 64
+
+/* 20 integer digits, a decimal point and up to 19 fraction digits. */
+#define NLX402_AMOUNT_DECIMALS_MAX 19
+#define NLX402_AMOUNT_MAX 40
+
+#define NLX402_KEY_MINT 0x1
+#define NLX402_KEY_RECIPIENT 0x2
+#define NLX402_KEY_TX 0x4
 
+#define NLX402_FLAT_VERSION 1
+#define NLX402_FLAT_METADATA 1
+#define NLX402_FLAT_QUOTE 2
+#define NLX402_FLAT_PAID_ACCESS 3
+
+#define NLX402_CPU_SCALAR 0
+#define NLX402_CPU_SSE42 1
+#define NLX402_CPU_AVX2 2
+#define NLX402_CPU_AVX512 3
+
+typedef struct {
+    void *(*malloc_fn)(void *ctx, size_t size);
+    void *(*realloc_fn)(void *ctx, void *ptr, size_t size);
+    void (*free_fn)(void *ctx, void *ptr);
+    void *ctx;
+} Nlx402Allocator;
 
 typedef struct {
     int ok;
     double created_at;
     char *wallet_id;
-    char *selected_mint;
+    const char *selected_mint;
+    unsigned int owned;     /* fields copied rather than interned, by schema index */
+    const Nlx402Allocator *allocator;
 } AuthMeResponse;
 
 typedef struct {
     int ok;
-    char *network;
-    char **supported_chains;
+    const char *network;
+    const char **supported_chains;
     int supported_chains_count;
-    char *version;
-    char **supported_mints;
+    const char *version;
+    const char **supported_mints;
     int supported_mints_count;
+    unsigned int owned;     /* fields copied rather than interned, by schema index */
+    const Nlx402Allocator *allocator;
 } MetadataResponse;
 
 typedef struct {
     char *amount;
-    char *chain;
+    unsigned long long amount_units;
+    int amount_exact;
+    const char *chain;
     int decimals;
     double expires_at;
-    char *mint;
-    char *network;
-    char *nonce;
-    char *recipient;
-    char *version;
+    char mint[NLX402_PUBKEY_MAX + 1];
+    const char *network;
+    char nonce[NLX402_NONCE_MAX + 1];
+    char recipient[NLX402_PUBKEY_MAX + 1];
+    const char *version;
+    unsigned char mint_key[NLX402_PUBKEY_BYTES];
+    unsigned char recipient_key[NLX402_PUBKEY_BYTES];
+    unsigned int keys_valid;
+    char *raw;          /* the quote exactly as received; sent back to /verify */
+    size_t raw_len;
+    unsigned int owned;     /* fields copied rather than interned, by schema index */
+    const Nlx402Allocator *allocator;
 } QuoteResponse;
 
 typedef struct {
@@ -41,492 +111,4352 @@ typedef struct {
 typedef struct {
     int ok;
     char *amount;
+    unsigned long long amount_units;
+    int amount_exact;
     int decimals;
-    char *mint;
-    char *nonce;
+    char mint[NLX402_PUBKEY_MAX + 1];
+    char nonce[NLX402_NONCE_MAX + 1];
     char *status;
-    char *tx;
-    char *version;
+    char tx[NLX402_SIGNATURE_MAX + 1];
+    const char *version;
+    unsigned char mint_key[NLX402_PUBKEY_BYTES];
+    unsigned char tx_sig[NLX402_SIGNATURE_BYTES];
+    unsigned int keys_valid;
+    unsigned int owned;     /* fields copied rather than interned, by schema index */
+    const Nlx402Allocator *allocator;
 } PaidAccessResponse;
 
+typedef struct {
+    const char *ptr;
+    size_t len;
+} Nlx402View;
+
+typedef struct {
+    unsigned int key_off;
+    unsigned int key_len;
+    unsigned int val_off;
+    unsigned int val_len;
+    int parent;
+    int count;
+    unsigned char type;
+    unsigned char escaped;
+} Nlx402LazyEntry;
+
+/* Raw body plus one index entry per value; see nlx402_lazy_*. */
+typedef struct {
+    char *body;
+    size_t len;
+    Nlx402LazyEntry *entries;
+    int count;
+    int cap;
+    const Nlx402Allocator *allocator;
+} Nlx402LazyResponse;
+
+typedef struct {
+    unsigned int *offsets;
+    char *data;
+} Nlx402StrColumn;
+
+typedef struct {
+    size_t count;
+    unsigned long long *amount_units;
+    double *expires_at;
+    long *http_status;
+    int *result;
+    int *decimals;
+    Nlx402StrColumn amount;
+    Nlx402StrColumn chain;
+    Nlx402StrColumn mint;
+    Nlx402StrColumn network;
+    Nlx402StrColumn nonce;
+    Nlx402StrColumn raw;            /* the body as sent, for nlx402_verify_quote */
+    Nlx402StrColumn recipient;
+    Nlx402StrColumn version;
+    void *block;
+    const Nlx402Allocator *allocator;
+} Nlx402QuoteBatch;
+
+typedef struct {
+    size_t count;
+    unsigned long long *amount_units;
+    long *http_status;
+    int *result;
+    int *ok;
+    int *decimals;
+    Nlx402StrColumn amount;
+    Nlx402StrColumn mint;
+    Nlx402StrColumn nonce;
+    Nlx402StrColumn status;
+    Nlx402StrColumn tx;
+    Nlx402StrColumn version;
+    void *block;
+    const Nlx402Allocator *allocator;
+} Nlx402PaidAccessBatch;
+
+typedef struct {
+    unsigned int hash;
+    size_t len;
+    char *str;
+} Nlx402InternEntry;
+
+typedef struct {
+    pthread_rwlock_t lock;
+    Nlx402InternEntry *entries;
+    size_t capacity;
+    size_t count;
+    size_t limit;
+    atomic_ullong rejected;
+} Nlx402InternTable;
+
+typedef enum {
+    NLX402_MEM_CLIENT,
+    NLX402_MEM_REQUESTS,
+    NLX402_MEM_RECV_BUFFERS,
+    NLX402_MEM_JSON,
+    NLX402_MEM_RESPONSES,
+    NLX402_MEM_CACHES,
+    NLX402_MEM_FLOWS,
+    NLX402_MEM_CATEGORIES
+} Nlx402MemCategory;
+
+typedef struct {
+    size_t current;
+    size_t peak;
+    unsigned long long allocs;
+} Nlx402MemCounter;
+
+typedef struct {
+    Nlx402MemCounter total;
+    Nlx402MemCounter by_category[NLX402_MEM_CATEGORIES];
+} Nlx402MemStats;
+
+typedef struct {
+    Nlx402Allocator backing;
+    atomic_size_t limit;
+    atomic_size_t current[NLX402_MEM_CATEGORIES + 1];
+    atomic_size_t peak[NLX402_MEM_CATEGORIES + 1];
+    atomic_ullong allocs[NLX402_MEM_CATEGORIES + 1];
+    atomic_ullong *rt_violations;   /* set in real-time mode */
+} Nlx402MemAccount;
+
+typedef struct Nlx402Handle {
+    struct Nlx402Handle *next;
+    CURL *curl;
+    char *recv;
+    size_t recv_size;
+    size_t recv_cap;
+    const Nlx402Allocator *allocator;
+    atomic_ullong *rt_violations;
+    char *send;
+    size_t send_cap;
+    struct JsonParser *parser;
+    int streaming;
+} Nlx402Handle;
+
 typedef struct {
     char *base_url;
     char *api_key;
+    Nlx402Allocator allocator;
+    Nlx402MemAccount accounting;
+    Nlx402InternTable interns;
+    pthread_mutex_t handles_lock;
+    Nlx402Handle *idle_handles;
+    int realtime;
+    atomic_ullong rt_violations;
+    unsigned char *rt_slab;
+    size_t rt_slab_size;
+    int rt_locked;
+    struct PoolReserve *rt_pool;
 } Nlx402Client;
 
+typedef struct {
+    int handles;
+    size_t recv_capacity;
+    unsigned int pool_blocks_per_class;
+    size_t pool_max_block;
+    size_t intern_capacity;
+    int lock_memory;
+    size_t send_capacity;
+} Nlx402RealtimeConfig;
+
+
+typedef struct {
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long large_allocs;
+    unsigned long long rejected;
+    size_t bytes_retained;
+} Nlx402PoolStats;
+
+typedef struct Nlx402ArenaBlock {
+    struct Nlx402ArenaBlock *next;
+    size_t size;
+    size_t used;
+} Nlx402ArenaBlock;
+
+typedef struct {
+    Nlx402ArenaBlock *blocks;
+    size_t block_size;
+    void *last;
+    size_t requested;
+    size_t overflow;
+    Nlx402ArenaBlock *fixed;
+    size_t fixed_base;
+    const Nlx402Allocator *backing;
+    Nlx402Allocator allocator;
+} Nlx402Arena;
+
+typedef struct {
+    Nlx402Client *client;
+    Nlx402Arena arena;
+} Nlx402Flow;
+
 
 typedef struct {
     char *data;
     size_t size;
 } MemoryChunk;
 
-static size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
-    size_t realsize = size * nmemb;
-    MemoryChunk *mem = (MemoryChunk *)userp;
+static void *default_malloc(void *ctx, size_t size) {
+    (void)ctx;
+    return malloc(size);
+}
 
-    char *ptr = realloc(mem->data, mem->size + realsize + 1);
-    if (ptr == NULL) {
-        return 0;
-    }
+static void *default_realloc(void *ctx, void *ptr, size_t size) {
+    (void)ctx;
+    return realloc(ptr, size);
+}
+
+static void default_free(void *ctx, void *ptr) {
+    (void)ctx;
+    free(ptr);
+}
 
-    mem->data = ptr;
-    memcpy(&(mem->data[mem->size]), contents, realsize);
-    mem->size += realsize;
-    mem->data[mem->size] = '\0';
+static const Nlx402Allocator default_allocator = { default_malloc, default_realloc, default_free, NULL };
 
-    return realsize;
+/* The category only travels as far as the allocator call; the client's
+ * accounting allocator reads it and records it next to the block. */
+static _Thread_local int mem_category;
+
+static void *mem_alloc(const Nlx402Allocator *a, int category, size_t size) {
+    mem_category = category;
+    return a->malloc_fn(a->ctx, size);
 }
 
-static char *dup_string(const char *s) {
-    if (!s) return NULL;
-    size_t len = strlen(s);
-    char *copy = (char *)malloc(len + 1);
-    if (!copy) return NULL;
-    memcpy(copy, s, len + 1);
-    return copy;
+static void *mem_realloc(const Nlx402Allocator *a, int category, void *ptr, size_t size) {
+    mem_category = category;
+    return a->realloc_fn(a->ctx, ptr, size);
 }
 
-void nlx402_client_init(Nlx402Client *client, const char *base_url, const char *api_key) {
-    client->base_url = dup_string(base_url ? base_url : "https://pay.thrt.ai");
-    client->api_key  = api_key ? dup_string(api_key) : NULL;
+static void *mem_calloc(const Nlx402Allocator *a, int category, size_t count, size_t size) {
+    if (size && count > (size_t)-1 / size) return NULL;
+    mem_category = category;
+    void *ptr = a->malloc_fn(a->ctx, count * size);
+    if (ptr) memset(ptr, 0, count * size);
+    return ptr;
+}
 
-    size_t len = strlen(client->base_url);
-    while (len > 0 && client->base_url[len - 1] == '/') {
-        client->base_url[len - 1] = '\0';
-        len--;
+static void mem_free(const Nlx402Allocator *a, void *ptr) {
+    if (ptr) a->free_fn(a->ctx, ptr);
+}
+
+/* Building with -DNLX402_ALLOC_TRACE adds nlx402_alloc_trace_allocator, a
+ * counting allocator a harness installs for the client and, through
+ * nlx402_global_init_mem, for libcurl, so it can run a flow N times and hold
+ * it to the NLX402_ALLOC_BUDGET_* figures below. They are the SDK's own
+ * malloc and realloc calls reaching the allocator per call, with the
+ * built-in JSON backend; pool hits count, arena bumps and frees do not.
+ * libcurl's calls are counted apart and only reported, since they depend on
+ * its version (7.88 over HTTP/1.1 makes 71 and 36). Every SDK call site is
+ * also counted by source line for the over-budget report. */
+#define NLX402_ALLOC_BUDGET_GET_AND_VERIFY_QUOTE 8
+#define NLX402_ALLOC_BUDGET_PAID_ACCESS 5
+
+#ifdef NLX402_ALLOC_TRACE
+#define ALLOC_TRACE_SITES 128
+
+typedef struct {
+    int line;
+    unsigned long long count;
+} Nlx402AllocSite;
+
+static struct {
+    pthread_mutex_t lock;
+    Nlx402AllocSite sites[ALLOC_TRACE_SITES];
+    size_t count;
+    atomic_ullong total;        /* calls reaching nlx402_alloc_trace_allocator */
+    atomic_ullong curl;         /* the part of total made by libcurl */
+} alloc_trace = { .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static void alloc_trace_hit(int line) {
+    pthread_mutex_lock(&alloc_trace.lock);
+    size_t i = 0;
+    while (i < alloc_trace.count && alloc_trace.sites[i].line != line) i++;
+    if (i == alloc_trace.count && i < ALLOC_TRACE_SITES) {
+        alloc_trace.sites[i].line = line;
+        alloc_trace.sites[i].count = 0;
+        alloc_trace.count++;
     }
+    if (i < alloc_trace.count) alloc_trace.sites[i].count++;
+    pthread_mutex_unlock(&alloc_trace.lock);
 }
 
-void nlx402_client_set_api_key(Nlx402Client *client, const char *api_key) {
-    if (client->api_key) free(client->api_key);
-    client->api_key = api_key ? dup_string(api_key) : NULL;
+#define mem_alloc(a, category, size) \
+    (alloc_trace_hit(__LINE__), mem_alloc((a), (category), (size)))
+#define mem_realloc(a, category, ptr, size) \
+    (alloc_trace_hit(__LINE__), mem_realloc((a), (category), (ptr), (size)))
+#define mem_calloc(a, category, count, size) \
+    (alloc_trace_hit(__LINE__), mem_calloc((a), (category), (count), (size)))
+
+void nlx402_alloc_trace_reset(void) {
+    pthread_mutex_lock(&alloc_trace.lock);
+    alloc_trace.count = 0;
+    atomic_store(&alloc_trace.total, 0);
+    atomic_store(&alloc_trace.curl, 0);
+    pthread_mutex_unlock(&alloc_trace.lock);
 }
 
-void nlx402_client_cleanup(Nlx402Client *client) {
-    if (client->base_url) free(client->base_url);
-    if (client->api_key) free(client->api_key);
+unsigned long long nlx402_alloc_trace_total(void) {
+    return atomic_load(&alloc_trace.total);
 }
 
-int nlx402_request(
-    Nlx402Client *client,
-    const char *path,
-    const char *method,
-    int require_api_key,
-    struct curl_slist *extra_headers,
-    const char *body,
-    long *out_status,
-    MemoryChunk *out_chunk
-) {
-    CURL *curl = NULL;
-    CURLcode res;
-    int retval = -1;
+/* The part of nlx402_alloc_trace_total made by libcurl. */
+unsigned long long nlx402_alloc_trace_curl(void) {
+    return atomic_load(&alloc_trace.curl);
+}
 
-    curl = curl_easy_init();
-    if (!curl) {
-        fprintf(stderr, "curl_easy_init failed\n");
-        return -1;
+/* Returns 0 if the SDK's allocations since the last reset average at most
+ * budget per call; otherwise -1, after writing the per-call count of every
+ * site to report. libcurl's allocations are left out of the budget and show
+ * up at the curl_*_cb lines. */
+int nlx402_alloc_trace_check(unsigned long long calls, unsigned long long budget, FILE *report) {
+    if (calls == 0) return 0;
+    pthread_mutex_lock(&alloc_trace.lock);
+    unsigned long long curl = atomic_load(&alloc_trace.curl);
+    unsigned long long sdk = atomic_load(&alloc_trace.total) - curl;
+    int over = sdk > budget * calls;
+    if (over && report) {
+        fprintf(report, "NLx402: %.1f allocations per call, budget %llu, plus %.1f by libcurl\n",
+                (double)sdk / (double)calls, budget, (double)curl / (double)calls);
+        for (size_t i = 0; i < alloc_trace.count; i++) {
+            fprintf(report, "  %s:%d  %.1f per call\n", __FILE__, alloc_trace.sites[i].line,
+                    (double)alloc_trace.sites[i].count / (double)calls);
+        }
     }
+    pthread_mutex_unlock(&alloc_trace.lock);
+    return over ? -1 : 0;
+}
+#endif
 
-    size_t url_len = strlen(client->base_url) + strlen(path) + 1;
-    char *url = (char *)malloc(url_len);
-    if (!url) {
-        curl_easy_cleanup(curl);
-        return -1;
-    }
-    snprintf(url, url_len, "%s%s", client->base_url, path);
+static const Nlx402Allocator *allocator_or_default(const Nlx402Allocator *a) {
+    return a ? a : &default_allocator;
+}
 
-    MemoryChunk chunk;
-    chunk.data = malloc(1);
-    chunk.size = 0;
+/* Process-wide pool of power-of-two buffers backing the default client
+ * allocator. Frees land in a per-thread cache; a cache that overflows, or a
+ * thread that exits, hands blocks to a mutex-guarded global depot, and a
+ * cache miss refills a batch from the depot before falling back to malloc.
+ * The block header holds the class and, for a block carved from a real-time
+ * client's reserve, that reserve, so a free always finds its way home. */
+#define POOL_MIN_SHIFT 5
+#define POOL_MAX_SHIFT 16
+#define POOL_CLASSES (POOL_MAX_SHIFT - POOL_MIN_SHIFT + 1)
+#define POOL_LARGE POOL_CLASSES
+#define POOL_HEADER 16
+#define POOL_THREAD_CACHE_MAX 32
+#define POOL_BATCH 16
+#define POOL_DEPOT_MAX 1024
 
-    curl_easy_setopt(curl, CURLOPT_URL, url);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
+typedef struct PoolBlock {
+    struct PoolBlock *next;
+} PoolBlock;
 
-    if (strcmp(method, "GET") == 0) {
-        curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
-    } else if (strcmp(method, "POST") == 0) {
-        curl_easy_setopt(curl, CURLOPT_POST, 1L);
-        if (body) {
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body);
-        }
-    } else {
-        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method);
-        if (body) {
-            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body);
-        }
-    }
+typedef struct {
+    PoolBlock *free[POOL_CLASSES];
+    unsigned int count[POOL_CLASSES];
+    int registered;
+} PoolThreadCache;
 
-    struct curl_slist *headers = NULL;
-    if (require_api_key) {
-        if (!client->api_key) {
-            fprintf(stderr, "NLx402: API key is required but not set.\n");
-            free(url);
-            free(chunk.data);
-            curl_easy_cleanup(curl);
-            return -1;
-        }
-        char api_header[256];
-        snprintf(api_header, sizeof(api_header), "x-api-key: %s", client->api_key);
-        headers = curl_slist_append(headers, api_header);
-    }
+static struct {
+    pthread_mutex_t lock;
+    PoolBlock *free[POOL_CLASSES];
+    unsigned int count[POOL_CLASSES];
+    atomic_ullong hits;
+    atomic_ullong misses;
+    atomic_ullong large_allocs;
+    atomic_ullong rejected;
+    atomic_size_t bytes_retained;
+} pool_depot = { .lock = PTHREAD_MUTEX_INITIALIZER };
 
-    if (extra_headers) {
-        struct curl_slist *tmp = extra_headers;
-        while (tmp) {
-            headers = curl_slist_append(headers, tmp->data);
-            tmp = tmp->next;
-        }
+/* One real-time client's blocks, carved from a slab that starts with this
+ * struct. A reserve serves the client's own allocations and, while one of
+ * its handles is held on the calling thread, libcurl's; a miss is refused
+ * rather than falling back to malloc. Frees go back one at a time under the
+ * lock, so every thread can draw on all of it. A retired reserve frees its
+ * slab once the last block comes back. */
+typedef struct PoolReserve {
+    pthread_mutex_t lock;
+    PoolBlock *free[POOL_CLASSES];
+    size_t outstanding;
+    size_t size;
+    int locked;
+    int retired;
+} PoolReserve;
+
+static _Thread_local PoolThreadCache pool_cache;
+static _Thread_local PoolReserve *pool_active;
+static _Thread_local int pool_active_depth;
+static pthread_key_t pool_cache_key;
+static pthread_once_t pool_key_once = PTHREAD_ONCE_INIT;
+
+static size_t pool_class_size(unsigned int cls) {
+    return (size_t)1 << (cls + POOL_MIN_SHIFT);
+}
+
+static unsigned int pool_class_for(size_t size) {
+    unsigned int cls = 0;
+    while (cls < POOL_CLASSES && pool_class_size(cls) < size) cls++;
+    return cls;
+}
+
+static void pool_depot_put(unsigned int cls, PoolBlock *first, PoolBlock *last, unsigned int n) {
+    pthread_mutex_lock(&pool_depot.lock);
+    if (pool_depot.count[cls] + n <= POOL_DEPOT_MAX) {
+        last->next = pool_depot.free[cls];
+        pool_depot.free[cls] = first;
+        pool_depot.count[cls] += n;
+        first = NULL;
     }
+    pthread_mutex_unlock(&pool_depot.lock);
 
-    if (headers) {
-        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    while (first) {
+        PoolBlock *next = first->next;
+        free((unsigned char *)first - POOL_HEADER);
+        atomic_fetch_sub_explicit(&pool_depot.bytes_retained, pool_class_size(cls), memory_order_relaxed);
+        first = next;
     }
+}
 
-    res = curl_easy_perform(curl);
-    if (res != CURLE_OK) {
-        fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
-        retval = -1;
-        goto cleanup;
+static void pool_flush_cache(void *arg) {
+    PoolThreadCache *cache = (PoolThreadCache *)arg;
+    for (unsigned int cls = 0; cls < POOL_CLASSES; cls++) {
+        PoolBlock *first = cache->free[cls];
+        if (!first) continue;
+        PoolBlock *last = first;
+        while (last->next) last = last->next;
+        pool_depot_put(cls, first, last, cache->count[cls]);
+        cache->free[cls] = NULL;
+        cache->count[cls] = 0;
     }
+}
 
-    long status_code = 0;
-    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code);
-    if (out_status) *out_status = status_code;
+static void pool_make_key(void) {
+    pthread_key_create(&pool_cache_key, pool_flush_cache);
+}
 
-    if (status_code < 200 || status_code >= 300) {
-        fprintf(stderr, "NLx402 request failed with status %ld, body: %s\n",
-                status_code, chunk.data ? chunk.data : "");
-        retval = -1;
-        goto cleanup;
-    }
+static void pool_register_thread(void) {
+    pthread_once(&pool_key_once, pool_make_key);
+    pthread_setspecific(pool_cache_key, &pool_cache);
+    pool_cache.registered = 1;
+}
 
-    if (out_chunk) {
-        out_chunk->data = chunk.data;
-        out_chunk->size = chunk.size;
-        chunk.data = NULL;
-    } else {
-        free(chunk.data);
+static int pool_refill(unsigned int cls) {
+    pthread_mutex_lock(&pool_depot.lock);
+    unsigned int n = 0;
+    while (n < POOL_BATCH && pool_depot.free[cls]) {
+        PoolBlock *b = pool_depot.free[cls];
+        pool_depot.free[cls] = b->next;
+        b->next = pool_cache.free[cls];
+        pool_cache.free[cls] = b;
+        n++;
     }
+    pool_depot.count[cls] -= n;
+    pthread_mutex_unlock(&pool_depot.lock);
+    pool_cache.count[cls] += n;
+    return n > 0;
+}
 
-    retval = 0;
+#define POOL_OWNER(ptr) (*(PoolReserve **)((unsigned char *)(ptr) - POOL_HEADER + 8))
 
-cleanup:
-    if (headers) curl_slist_free_all(headers);
-    if (chunk.data) free(chunk.data);
-    free(url);
-    curl_easy_cleanup(curl);
-    return retval;
+/* The reserve an allocation draws on: the client's, passed as the pool
+ * allocator's context, or the one active on this thread for libcurl. */
+static PoolReserve *pool_reserve_for(void *ctx) {
+    return ctx ? (PoolReserve *)ctx : pool_active;
 }
 
+static void pool_enter(PoolReserve *r) {
+    if (pool_active_depth++ == 0) pool_active = r;
+}
 
-int nlx402_get_metadata(Nlx402Client *client, MetadataResponse *out) {
-    long status;
-    MemoryChunk chunk = {0};
-    int rc = nlx402_request(client, "/api/metadata", "GET", 0, NULL, NULL, &status, &chunk);
-    if (rc != 0) return rc;
-
-    cJSON *root = cJSON_Parse(chunk.data);
-    if (!root) {
-        fprintf(stderr, "Failed to parse JSON from /api/metadata\n");
-        free(chunk.data);
-        return -1;
-    }
+static void pool_leave(void) {
+    if (--pool_active_depth == 0) pool_active = NULL;
+}
 
-    memset(out, 0, sizeof(*out));
-    out->ok = cJSON_IsTrue(cJSON_GetObjectItem(root, "ok"));
-
-    cJSON *metadata = cJSON_GetObjectItem(root, "metadata");
-    if (metadata && cJSON_IsObject(metadata)) {
-        cJSON *network = cJSON_GetObjectItem(metadata, "network");
-        cJSON *version = cJSON_GetObjectItem(metadata, "version");
-        cJSON *chains  = cJSON_GetObjectItem(metadata, "supported_chains");
-
-        if (cJSON_IsString(network)) out->network = dup_string(network->valuestring);
-        if (cJSON_IsString(version)) out->version = dup_string(version->valuestring);
-
-        if (cJSON_IsArray(chains)) {
-            int count = cJSON_GetArraySize(chains);
-            out->supported_chains = (char **)calloc(count, sizeof(char *));
-            out->supported_chains_count = count;
-            for (int i = 0; i < count; i++) {
-                cJSON *item = cJSON_GetArrayItem(chains, i);
-                if (cJSON_IsString(item)) {
-                    out->supported_chains[i] = dup_string(item->valuestring);
-                }
-            }
+static void *pool_reserve_take(PoolReserve *r, unsigned int cls) {
+    PoolBlock *b = NULL;
+    if (cls != POOL_LARGE) {
+        pthread_mutex_lock(&r->lock);
+        b = r->free[cls];
+        if (b) {
+            r->free[cls] = b->next;
+            r->outstanding++;
         }
+        pthread_mutex_unlock(&r->lock);
     }
+    atomic_fetch_add_explicit(b ? &pool_depot.hits : &pool_depot.rejected, 1, memory_order_relaxed);
+    return b;
+}
 
-    cJSON *mints = cJSON_GetObjectItem(root, "supported_mints");
-    if (cJSON_IsArray(mints)) {
-        int count = cJSON_GetArraySize(mints);
-        out->supported_mints = (char **)calloc(count, sizeof(char *));
-        out->supported_mints_count = count;
-        for (int i = 0; i < count; i++) {
-            cJSON *item = cJSON_GetArrayItem(mints, i);
-            if (cJSON_IsString(item)) {
-                out->supported_mints[i] = dup_string(item->valuestring);
-            }
+static void pool_reserve_destroy(PoolReserve *r) {
+    pthread_mutex_destroy(&r->lock);
+    if (r->locked) munlock(r, r->size);
+    free(r);
+}
+
+static void pool_reserve_put(PoolReserve *r, unsigned int cls, PoolBlock *b) {
+    pthread_mutex_lock(&r->lock);
+    b->next = r->free[cls];
+    r->free[cls] = b;
+    int done = --r->outstanding == 0 && r->retired;
+    pthread_mutex_unlock(&r->lock);
+    if (done) pool_reserve_destroy(r);
+}
+
+static void *pool_malloc(void *ctx, size_t size) {
+    unsigned int cls = pool_class_for(size);
+    unsigned char *raw;
+
+    PoolReserve *r = pool_reserve_for(ctx);
+    if (r) return pool_reserve_take(r, cls);
+
+    if (cls == POOL_LARGE) {
+        if (size > (size_t)-1 - POOL_HEADER) return NULL;
+        raw = (unsigned char *)malloc(POOL_HEADER + size);
+        if (!raw) return NULL;
+        atomic_fetch_add_explicit(&pool_depot.large_allocs, 1, memory_order_relaxed);
+    } else {
+        if (!pool_cache.registered) pool_register_thread();
+        if (pool_cache.free[cls] || pool_refill(cls)) {
+            PoolBlock *b = pool_cache.free[cls];
+            pool_cache.free[cls] = b->next;
+            pool_cache.count[cls]--;
+            atomic_fetch_add_explicit(&pool_depot.hits, 1, memory_order_relaxed);
+            atomic_fetch_sub_explicit(&pool_depot.bytes_retained, pool_class_size(cls), memory_order_relaxed);
+            return b;
         }
+        raw = (unsigned char *)malloc(POOL_HEADER + pool_class_size(cls));
+        if (!raw) return NULL;
+        atomic_fetch_add_explicit(&pool_depot.misses, 1, memory_order_relaxed);
     }
 
-    cJSON_Delete(root);
-    free(chunk.data);
-    return 0;
+    *(unsigned int *)raw = cls;
+    *(PoolReserve **)(raw + 8) = NULL;
+    return raw + POOL_HEADER;
 }
 
-void nlx402_free_metadata(MetadataResponse *m) {
-    if (!m) return;
-    if (m->network) free(m->network);
-    if (m->version) free(m->version);
-    for (int i = 0; i < m->supported_chains_count; i++) {
-        if (m->supported_chains && m->supported_chains[i])
-            free(m->supported_chains[i]);
+static void pool_free(void *ctx, void *ptr) {
+    (void)ctx;
+    if (!ptr) return;
+    unsigned int cls = *(unsigned int *)((unsigned char *)ptr - POOL_HEADER);
+    if (cls == POOL_LARGE) {
+        free((unsigned char *)ptr - POOL_HEADER);
+        return;
     }
-    if (m->supported_chains) free(m->supported_chains);
 
-    for (int i = 0; i < m->supported_mints_count; i++) {
-        if (m->supported_mints && m->supported_mints[i])
-            free(m->supported_mints[i]);
+    PoolBlock *b = (PoolBlock *)ptr;
+    if (POOL_OWNER(ptr)) {
+        pool_reserve_put(POOL_OWNER(ptr), cls, b);
+        return;
     }
-    if (m->supported_mints) free(m->supported_mints);
-}
 
+    atomic_fetch_add_explicit(&pool_depot.bytes_retained, pool_class_size(cls), memory_order_relaxed);
+    if (!pool_cache.registered) pool_register_thread();
+    b->next = pool_cache.free[cls];
+    pool_cache.free[cls] = b;
+    pool_cache.count[cls]++;
 
-int nlx402_get_auth_me(Nlx402Client *client, AuthMeResponse *out) {
-    long status;
-    MemoryChunk chunk = {0};
-    int rc = nlx402_request(client, "/api/auth/me", "GET", 1, NULL, NULL, &status, &chunk);
-    if (rc != 0) return rc;
+    if (pool_cache.count[cls] > POOL_THREAD_CACHE_MAX) {
+        PoolBlock *first = pool_cache.free[cls];
+        PoolBlock *last = first;
+        for (unsigned int i = 1; i < POOL_BATCH; i++) last = last->next;
+        pool_cache.free[cls] = last->next;
+        pool_cache.count[cls] -= POOL_BATCH;
+        pool_depot_put(cls, first, last, POOL_BATCH);
+    }
+}
 
-    cJSON *root = cJSON_Parse(chunk.data);
-    if (!root) {
-        fprintf(stderr, "Failed to parse JSON from /api/auth/me\n");
-        free(chunk.data);
-        return -1;
+static void *pool_realloc(void *ctx, void *ptr, size_t size) {
+    if (!ptr) return pool_malloc(ctx, size);
+    unsigned int cls = *(unsigned int *)((unsigned char *)ptr - POOL_HEADER);
+    if (cls == POOL_LARGE) {
+        if (pool_class_for(size) == POOL_LARGE) {
+            if (size > (size_t)-1 - POOL_HEADER) return NULL;
+            if (pool_reserve_for(ctx)) {
+                atomic_fetch_add_explicit(&pool_depot.rejected, 1, memory_order_relaxed);
+                return NULL;
+            }
+            unsigned char *raw = (unsigned char *)realloc((unsigned char *)ptr - POOL_HEADER, POOL_HEADER + size);
+            return raw ? raw + POOL_HEADER : NULL;
+        }
+    } else if (size <= pool_class_size(cls)) {
+        return ptr;
     }
 
-    memset(out, 0, sizeof(*out));
-    out->ok = cJSON_IsTrue(cJSON_GetObjectItem(root, "ok"));
+    void *copy = pool_malloc(ctx, size);
+    if (!copy) return NULL;
+    size_t old_size = cls == POOL_LARGE ? size : pool_class_size(cls);
+    memcpy(copy, ptr, old_size < size ? old_size : size);
+    pool_free(ctx, ptr);
+    return copy;
+}
 
-    cJSON *created_at = cJSON_GetObjectItem(root, "created_at");
-    if (cJSON_IsNumber(created_at)) out->created_at = created_at->valuedouble;
+/* Carves per_class blocks of every class up to max_block out of one slab
+ * into a new reserve. */
+static PoolReserve *pool_reserve_create(unsigned int per_class, size_t max_block, int lock) {
+    unsigned int top = pool_class_for(max_block);
+    if (top == POOL_LARGE) top = POOL_CLASSES - 1;
 
-    cJSON *wallet_id = cJSON_GetObjectItem(root, "wallet_id");
-    cJSON *selected_mint = cJSON_GetObjectItem(root, "selected_mint");
-    if (cJSON_IsString(wallet_id)) out->wallet_id = dup_string(wallet_id->valuestring);
-    if (cJSON_IsString(selected_mint)) out->selected_mint = dup_string(selected_mint->valuestring);
+    size_t head = (sizeof(PoolReserve) + POOL_HEADER - 1) & ~(size_t)(POOL_HEADER - 1);
+    size_t total = head;
+    for (unsigned int cls = 0; cls <= top; cls++) {
+        total += (size_t)per_class * (POOL_HEADER + pool_class_size(cls));
+    }
+    PoolReserve *r = (PoolReserve *)malloc(total);
+    if (!r) return NULL;
+    memset(r, 0, total);
+    if (lock && mlock(r, total) != 0) {
+        free(r);
+        return NULL;
+    }
+    pthread_mutex_init(&r->lock, NULL);
+    r->size = total;
+    r->locked = lock;
 
-    cJSON_Delete(root);
-    free(chunk.data);
-    return 0;
+    unsigned char *p = (unsigned char *)r + head;
+    for (unsigned int cls = 0; cls <= top; cls++) {
+        for (unsigned int i = 0; i < per_class; i++) {
+            *(unsigned int *)p = cls;
+            *(PoolReserve **)(p + 8) = r;
+            PoolBlock *b = (PoolBlock *)(p + POOL_HEADER);
+            b->next = r->free[cls];
+            r->free[cls] = b;
+            p += POOL_HEADER + pool_class_size(cls);
+        }
+    }
+    return r;
 }
 
-void nlx402_free_auth_me(AuthMeResponse *r) {
-    if (!r) return;
-    if (r->wallet_id) free(r->wallet_id);
-    if (r->selected_mint) free(r->selected_mint);
+/* The slab goes once every block is back, now or at the last free. */
+static void pool_reserve_retire(PoolReserve *r) {
+    pthread_mutex_lock(&r->lock);
+    r->retired = 1;
+    int done = r->outstanding == 0;
+    pthread_mutex_unlock(&r->lock);
+    if (done) pool_reserve_destroy(r);
 }
 
+static const Nlx402Allocator pool_allocator = { pool_malloc, pool_realloc, pool_free, NULL };
 
-int nlx402_get_quote(Nlx402Client *client, double total_price, QuoteResponse *out) {
-    long status;
-    MemoryChunk chunk = {0};
+const Nlx402Allocator *nlx402_pool_allocator(void) {
+    return &pool_allocator;
+}
 
-    if (total_price <= 0.0) total_price = 0.5;
+#ifdef NLX402_ALLOC_TRACE
+static void *trace_malloc(void *ctx, size_t size) {
+    atomic_fetch_add_explicit(&alloc_trace.total, 1, memory_order_relaxed);
+    return pool_malloc(ctx, size);
+}
 
-    char header_buf[128];
-    snprintf(header_buf, sizeof(header_buf), "x-total-price: %.8f", total_price);
+static void *trace_realloc(void *ctx, void *ptr, size_t size) {
+    atomic_fetch_add_explicit(&alloc_trace.total, 1, memory_order_relaxed);
+    return pool_realloc(ctx, ptr, size);
+}
 
-    struct curl_slist extra;
-    extra.data = header_buf;
-    extra.next = NULL;
+static const Nlx402Allocator trace_allocator = { trace_malloc, trace_realloc, pool_free, NULL };
 
-    int rc = nlx402_request(client, "/protected", "GET", 1, &extra, NULL, &status, &chunk);
-    if (rc != 0) return rc;
+/* The pool allocator, counting every malloc and realloc call. */
+const Nlx402Allocator *nlx402_alloc_trace_allocator(void) {
+    return &trace_allocator;
+}
 
-    cJSON *root = cJSON_Parse(chunk.data);
-    if (!root) {
-        fprintf(stderr, "Failed to parse JSON from /protected (quote)\n");
-        free(chunk.data);
-        return -1;
-    }
+/* What nlx402_global_init_mem hands libcurl in its place, so libcurl's
+ * calls are also counted apart. */
+static void *trace_curl_malloc(void *ctx, size_t size) {
+    atomic_fetch_add_explicit(&alloc_trace.curl, 1, memory_order_relaxed);
+    return trace_malloc(ctx, size);
+}
 
-    memset(out, 0, sizeof(*out));
+static void *trace_curl_realloc(void *ctx, void *ptr, size_t size) {
+    atomic_fetch_add_explicit(&alloc_trace.curl, 1, memory_order_relaxed);
+    return trace_realloc(ctx, ptr, size);
+}
 
-    cJSON *amount = cJSON_GetObjectItem(root, "amount");
-    cJSON *chain  = cJSON_GetObjectItem(root, "chain");
-    cJSON *decimals = cJSON_GetObjectItem(root, "decimals");
-    cJSON *expires_at = cJSON_GetObjectItem(root, "expires_at");
-    cJSON *mint   = cJSON_GetObjectItem(root, "mint");
-    cJSON *network= cJSON_GetObjectItem(root, "network");
-    cJSON *nonce  = cJSON_GetObjectItem(root, "nonce");
-    cJSON *recipient = cJSON_GetObjectItem(root, "recipient");
-    cJSON *version  = cJSON_GetObjectItem(root, "version");
-
-    if (cJSON_IsString(amount)) out->amount = dup_string(amount->valuestring);
-    if (cJSON_IsString(chain)) out->chain = dup_string(chain->valuestring);
-    if (cJSON_IsNumber(decimals)) out->decimals = decimals->valueint;
-    if (cJSON_IsNumber(expires_at)) out->expires_at = expires_at->valuedouble;
-    if (cJSON_IsString(mint)) out->mint = dup_string(mint->valuestring);
-    if (cJSON_IsString(network)) out->network = dup_string(network->valuestring);
-    if (cJSON_IsString(nonce)) out->nonce = dup_string(nonce->valuestring);
-    if (cJSON_IsString(recipient)) out->recipient = dup_string(recipient->valuestring);
-    if (cJSON_IsString(version)) out->version = dup_string(version->valuestring);
+static const Nlx402Allocator trace_curl_allocator = { trace_curl_malloc, trace_curl_realloc, pool_free, NULL };
+#endif
 
-    cJSON_Delete(root);
-    free(chunk.data);
-    return 0;
+void nlx402_pool_stats(Nlx402PoolStats *out) {
+    out->hits = atomic_load_explicit(&pool_depot.hits, memory_order_relaxed);
+    out->misses = atomic_load_explicit(&pool_depot.misses, memory_order_relaxed);
+    out->large_allocs = atomic_load_explicit(&pool_depot.large_allocs, memory_order_relaxed);
+    out->rejected = atomic_load_explicit(&pool_depot.rejected, memory_order_relaxed);
+    out->bytes_retained = atomic_load_explicit(&pool_depot.bytes_retained, memory_order_relaxed);
 }
 
-void nlx402_free_quote(QuoteResponse *q) {
-    if (!q) return;
-    if (q->amount) free(q->amount);
-    if (q->chain) free(q->chain);
-    if (q->mint) free(q->mint);
-    if (q->network) free(q->network);
-    if (q->nonce) free(q->nonce);
-    if (q->recipient) free(q->recipient);
-    if (q->version) free(q->version);
+/* Returns the calling thread's cached blocks and the whole depot to the
+ * system allocator. */
+void nlx402_pool_trim(void) {
+    pool_flush_cache(&pool_cache);
+    for (unsigned int cls = 0; cls < POOL_CLASSES; cls++) {
+        pthread_mutex_lock(&pool_depot.lock);
+        PoolBlock *b = pool_depot.free[cls];
+        pool_depot.free[cls] = NULL;
+        pool_depot.count[cls] = 0;
+        pthread_mutex_unlock(&pool_depot.lock);
+        while (b) {
+            PoolBlock *next = b->next;
+            free((unsigned char *)b - POOL_HEADER);
+            atomic_fetch_sub_explicit(&pool_depot.bytes_retained, pool_class_size(cls), memory_order_relaxed);
+            b = next;
+        }
+    }
 }
 
+/* Each arena allocation is preceded by its size so realloc can copy; the
+ * most recent allocation can grow or be released in place. */
+#define ARENA_ALIGN 16
+#define ARENA_HEADER ARENA_ALIGN
+#define ARENA_HEADER_BLOCK ((sizeof(Nlx402ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+#define ARENA_BLOCK_DATA(b) ((unsigned char *)(b) + ARENA_HEADER_BLOCK)
+#define ARENA_DEFAULT_BLOCK 4096
 
-int nlx402_verify_quote(Nlx402Client *client, const QuoteResponse *quote, const char *nonce, VerifyResponse *out) {
-    if (!nonce || !quote || !quote->nonce) {
-        fprintf(stderr, "verify_quote: nonce and quote are required\n");
-        return -1;
-    }
+static size_t arena_round(size_t size) {
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
 
-    cJSON *q = cJSON_CreateObject();
-    if (!q) return -1;
-    cJSON_AddStringToObject(q, "amount", quote->amount ? quote->amount : "");
-    cJSON_AddStringToObject(q, "chain", quote->chain ? quote->chain : "");
-    cJSON_AddNumberToObject(q, "decimals", quote->decimals);
-    cJSON_AddNumberToObject(q, "expires_at", quote->expires_at);
-    cJSON_AddStringToObject(q, "mint", quote->mint ? quote->mint : "");
-    cJSON_AddStringToObject(q, "network", quote->network ? quote->network : "");
-    cJSON_AddStringToObject(q, "nonce", quote->nonce ? quote->nonce : "");
-    cJSON_AddStringToObject(q, "recipient", quote->recipient ? quote->recipient : "");
-    cJSON_AddStringToObject(q, "version", quote->version ? quote->version : "");
-
-    char *quote_str = cJSON_PrintUnformatted(q);
-    cJSON_Delete(q);
-    if (!quote_str) return -1;
-
-    size_t body_len = strlen("payment_data=") + strlen(quote_str) + strlen("&nonce=") + strlen(nonce) + 1;
-    char *body = (char *)malloc(body_len);
-    if (!body) {
-        free(quote_str);
-        return -1;
+static void *arena_malloc(void *ctx, size_t size) {
+    Nlx402Arena *arena = (Nlx402Arena *)ctx;
+    if (size > (size_t)-1 / 2) return NULL;
+    size_t need = ARENA_HEADER + arena_round(size);
+    arena->requested += need;
+
+    Nlx402ArenaBlock *b = arena->blocks;
+    if (!b || b->size - b->used < need) {
+        if (arena->fixed_base) arena->overflow += need;
+        if (!arena->backing) return NULL;
+        size_t block_size = arena->block_size;
+        if (block_size < need) block_size = need;
+        b = (Nlx402ArenaBlock *)mem_alloc(arena->backing, NLX402_MEM_FLOWS, ARENA_HEADER_BLOCK + block_size);
+        if (!b) return NULL;
+        b->next = arena->blocks;
+        b->size = block_size;
+        b->used = 0;
+        arena->blocks = b;
     }
-    snprintf(body, body_len, "payment_data=%s&nonce=%s", quote_str, nonce);
 
-    struct curl_slist extra_headers;
-    extra_headers.data = "Content-Type: application/x-www-form-urlencoded";
-    extra_headers.next = NULL;
+    unsigned char *p = ARENA_BLOCK_DATA(b) + b->used;
+    *(size_t *)p = size;
+    b->used += need;
+    arena->last = p + ARENA_HEADER;
+    return arena->last;
+}
 
-    long status;
-    MemoryChunk chunk = {0};
-    int rc = nlx402_request(client, "/verify", "POST", 1, &extra_headers, body, &status, &chunk);
+static void *arena_realloc(void *ctx, void *ptr, size_t size) {
+    Nlx402Arena *arena = (Nlx402Arena *)ctx;
+    if (!ptr) return arena_malloc(ctx, size);
 
-    free(quote_str);
-    free(body);
+    size_t *header = (size_t *)((unsigned char *)ptr - ARENA_HEADER);
+    size_t old_size = *header;
+    Nlx402ArenaBlock *b = arena->blocks;
+    if (ptr == arena->last && size <= (size_t)-1 / 2) {
+        size_t start = (size_t)((unsigned char *)ptr - ARENA_BLOCK_DATA(b));
+        if (start + arena_round(size) <= b->size) {
+            if (arena_round(size) > arena_round(old_size)) arena->requested += arena_round(size) - arena_round(old_size);
+            b->used = start + arena_round(size);
+            *header = size;
+            return ptr;
+        }
+    }
 
-    if (rc != 0) return rc;
+    void *copy = arena_malloc(ctx, size);
+    if (!copy) return NULL;
+    memcpy(copy, ptr, old_size < size ? old_size : size);
+    return copy;
+}
 
-    cJSON *root = cJSON_Parse(chunk.data);
-    if (!root) {
-        fprintf(stderr, "Failed to parse JSON from /verify\n");
-        free(chunk.data);
-        return -1;
+static void arena_free(void *ctx, void *ptr) {
+    Nlx402Arena *arena = (Nlx402Arena *)ctx;
+    if (ptr && ptr == arena->last) {
+        Nlx402ArenaBlock *b = arena->blocks;
+        b->used = (size_t)((unsigned char *)ptr - ARENA_HEADER - ARENA_BLOCK_DATA(b));
+        arena->last = NULL;
     }
+}
 
-    memset(out, 0, sizeof(*out));
-    out->ok = cJSON_IsTrue(cJSON_GetObjectItem(root, "ok"));
+static void arena_init(Nlx402Arena *arena, const Nlx402Allocator *backing, size_t block_size) {
+    memset(arena, 0, sizeof(*arena));
+    arena->backing = backing;
+    arena->block_size = block_size ? block_size : ARENA_DEFAULT_BLOCK;
+    arena->allocator.malloc_fn = arena_malloc;
+    arena->allocator.realloc_fn = arena_realloc;
+    arena->allocator.free_fn = arena_free;
+    arena->allocator.ctx = arena;
+}
 
-    cJSON_Delete(root);
-    free(chunk.data);
-    return 0;
+/* An arena over caller memory only: once that runs out, allocations fail.
+ * arena_fixed_needed counts every allocation the call asked for, the failed
+ * one included, and never drops on free, so it is a lower bound on what the
+ * call needs, exact once the call gets past its last allocation. */
+static void arena_init_fixed(Nlx402Arena *arena, void *buf, size_t cap) {
+    arena_init(arena, NULL, 0);
+    size_t pad = (ARENA_ALIGN - ((size_t)buf & (ARENA_ALIGN - 1))) & (ARENA_ALIGN - 1);
+    arena->fixed_base = pad + ARENA_HEADER_BLOCK;
+    if (!buf || cap < pad + ARENA_HEADER_BLOCK) return;
+    Nlx402ArenaBlock *b = (Nlx402ArenaBlock *)((unsigned char *)buf + pad);
+    b->next = NULL;
+    b->size = cap - pad - ARENA_HEADER_BLOCK;
+    b->used = 0;
+    arena->blocks = b;
+    arena->fixed = b;
 }
 
+static size_t arena_fixed_needed(const Nlx402Arena *arena) {
+    return arena->fixed_base + arena->requested;
+}
 
-int nlx402_get_paid_access(Nlx402Client *client, const char *tx, const char *nonce, PaidAccessResponse *out) {
-    if (!tx || !nonce) {
-        fprintf(stderr, "get_paid_access: tx and nonce are required\n");
-        return -1;
+static void *borrowed_malloc(void *ctx, size_t size) {
+    (void)ctx;
+    (void)size;
+    return NULL;
+}
+
+static void *borrowed_realloc(void *ctx, void *ptr, size_t size) {
+    (void)ctx;
+    (void)ptr;
+    (void)size;
+    return NULL;
+}
+
+static void borrowed_free(void *ctx, void *ptr) {
+    (void)ctx;
+    (void)ptr;
+}
+
+/* Marks responses whose strings live in a caller-owned buffer. */
+static const Nlx402Allocator borrowed_allocator = { borrowed_malloc, borrowed_realloc, borrowed_free, NULL };
+
+static void arena_release(Nlx402Arena *arena) {
+    Nlx402ArenaBlock *b = arena->blocks;
+    while (b && b != arena->fixed) {
+        Nlx402ArenaBlock *next = b->next;
+        mem_free(arena->backing, b);
+        b = next;
+    }
+    arena->blocks = arena->fixed;
+    arena->last = NULL;
+}
+
+/* Keeps a single block; if the flow spilled into several, they are merged
+ * into one block sized for the whole flow on the next allocation. */
+static void arena_reset(Nlx402Arena *arena) {
+    Nlx402ArenaBlock *b = arena->blocks;
+    if (!b) return;
+    if (b->next) {
+        size_t total = 0;
+        for (; b; b = b->next) total += b->size;
+        arena_release(arena);
+        if (arena->block_size < total) arena->block_size = total;
+        return;
+    }
+    b->used = 0;
+    arena->last = NULL;
+}
+
+#if defined(NLX402_JSON_CJSON)
+/* cJSON and libcurl only take global, context-free hooks. cJSON trees never
+ * outlive a single SDK call, so its hooks follow the calling thread's current
+ * allocator; libcurl keeps memory across calls and gets one process-wide one. */
+static _Thread_local const Nlx402Allocator *cjson_allocator;
+static pthread_once_t cjson_hooks_once = PTHREAD_ONCE_INIT;
+
+static void *cjson_malloc(size_t size) {
+    return mem_alloc(allocator_or_default(cjson_allocator), NLX402_MEM_JSON, size);
+}
+
+static void cjson_free(void *ptr) {
+    mem_free(allocator_or_default(cjson_allocator), ptr);
+}
+
+static void install_cjson_hooks(void) {
+    cJSON_Hooks hooks = { cjson_malloc, cjson_free };
+    cJSON_InitHooks(&hooks);
+}
+
+static const Nlx402Allocator *cjson_enter(const Nlx402Allocator *a) {
+    const Nlx402Allocator *prev = cjson_allocator;
+    cjson_allocator = a;
+    return prev;
+}
+
+static void cjson_leave(const Nlx402Allocator *prev) {
+    cjson_allocator = prev;
+}
+#elif defined(NLX402_JSON_YYJSON)
+/* yyjson takes an allocator per call, so it uses the caller's directly. */
+static void *yyjson_malloc_cb(void *ctx, size_t size) {
+    return mem_alloc((const Nlx402Allocator *)ctx, NLX402_MEM_JSON, size);
+}
+
+static void *yyjson_realloc_cb(void *ctx, void *ptr, size_t old_size, size_t size) {
+    (void)old_size;
+    return mem_realloc((const Nlx402Allocator *)ctx, NLX402_MEM_JSON, ptr, size);
+}
+
+static void yyjson_free_cb(void *ctx, void *ptr) {
+    mem_free((const Nlx402Allocator *)ctx, ptr);
+}
+
+static yyjson_alc yyjson_allocator(const Nlx402Allocator *a) {
+    yyjson_alc alc = { yyjson_malloc_cb, yyjson_realloc_cb, yyjson_free_cb, (void *)a };
+    return alc;
+}
+#endif
+
+static Nlx402Allocator curl_allocator = { default_malloc, default_realloc, default_free, NULL };
+
+static void *curl_malloc_cb(size_t size) {
+    return mem_alloc(&curl_allocator, NLX402_MEM_CLIENT, size);
+}
+
+static void curl_free_cb(void *ptr) {
+    mem_free(&curl_allocator, ptr);
+}
+
+static void *curl_realloc_cb(void *ptr, size_t size) {
+    return mem_realloc(&curl_allocator, NLX402_MEM_CLIENT, ptr, size);
+}
+
+static char *curl_strdup_cb(const char *s) {
+    size_t len = strlen(s);
+    char *copy = (char *)mem_alloc(&curl_allocator, NLX402_MEM_CLIENT, len + 1);
+    if (copy) memcpy(copy, s, len + 1);
+    return copy;
+}
+
+static void *curl_calloc_cb(size_t count, size_t size) {
+    return mem_calloc(&curl_allocator, NLX402_MEM_CLIENT, count, size);
+}
+
+int nlx402_global_init_mem(long flags, const Nlx402Allocator *allocator) {
+    curl_allocator = *allocator_or_default(allocator);
+#ifdef NLX402_ALLOC_TRACE
+    if (allocator == &trace_allocator) curl_allocator = trace_curl_allocator;
+#endif
+    CURLcode res = curl_global_init_mem(flags, curl_malloc_cb, curl_free_cb,
+                                        curl_realloc_cb, curl_strdup_cb, curl_calloc_cb);
+    return res == CURLE_OK ? 0 : -1;
+}
+
+/* Each pooled handle keeps its receive buffer across requests. It grows
+ * geometrically, is presized from Content-Length, and is only dropped when a
+ * one-off large response pushed it past RECV_RETAIN_MAX. */
+#define RECV_MIN_CAPACITY 1024
+#define RECV_RETAIN_MAX (256 * 1024)
+
+/* RFC 3986 unreserved characters go into a form body as they are; every
+ * other byte is percent-encoded. */
+static const unsigned char url_safe[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0,
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 1,
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 1, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+/* Scanning kernels find the end of a run of ordinary bytes: string content
+ * that needs no escaping, or form characters that need no percent-encoding.
+ * On x86-64 there are SSE4.2, AVX2 and AVX-512 versions besides the scalar
+ * loops; the best the CPU supports is picked on first client init and called
+ * through a pointer. NLX402_CPU=scalar|sse4.2|avx2|avx512 in the environment,
+ * or nlx402_set_cpu_level, selects a lower level for comparison. */
+static size_t json_plain_run_scalar(const char *s, size_t n) {
+    size_t i = 0;
+    while (i < n && s[i] != '"' && s[i] != '\\' && (unsigned char)s[i] >= 0x20) i++;
+    return i;
+}
+
+static size_t url_safe_run_scalar(const char *s, size_t n) {
+    size_t i = 0;
+    while (i < n && url_safe[(unsigned char)s[i]]) i++;
+    return i;
+}
+
+#if CPU_X86
+/* pcmpestri with range pairs: the first byte inside (JSON) or outside (URL)
+ * any of the ranges. The vector loops end with a block that overlaps the one
+ * before it, whose bytes are already known to be ordinary, rather than a
+ * scalar tail. Short inputs go to the scalar loop, not the SSE version, to
+ * keep legacy SSE code out of the AVX paths. */
+__attribute__((target("sse4.2")))
+static size_t json_plain_run_sse42(const char *s, size_t n) {
+    const __m128i stops = _mm_setr_epi8(0x00, 0x1f, '"', '"', '\\', '\\', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    if (n < 16) return json_plain_run_scalar(s, n);
+    for (size_t i = 0;; i += 16) {
+        if (i + 16 > n) i = n - 16;
+        __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+        int k = _mm_cmpestri(stops, 6, v, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES);
+        if (k < 16) return i + (size_t)k;
+        if (i + 16 == n) return n;
+    }
+}
+
+__attribute__((target("sse4.2")))
+static size_t url_safe_run_sse42(const char *s, size_t n) {
+    const __m128i safe = _mm_setr_epi8('0', '9', 'A', 'Z', 'a', 'z', '-', '-', '.', '.', '_', '_', '~', '~', 0, 0);
+    if (n < 16) return url_safe_run_scalar(s, n);
+    for (size_t i = 0;; i += 16) {
+        if (i + 16 > n) i = n - 16;
+        __m128i v = _mm_loadu_si128((const __m128i *)(s + i));
+        int k = _mm_cmpestri(safe, 14, v, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_NEGATIVE_POLARITY);
+        if (k < 16) return i + (size_t)k;
+        if (i + 16 == n) return n;
+    }
+}
+
+/* v in [lo, lo + span], as an unsigned byte compare. */
+__attribute__((target("avx2")))
+static __m256i avx2_in_range(__m256i v, char lo, char span) {
+    __m256i d = _mm256_sub_epi8(v, _mm256_set1_epi8(lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(span)), d);
+}
+
+__attribute__((target("avx2")))
+static size_t json_plain_run_avx2(const char *s, size_t n) {
+    if (n < 32) return json_plain_run_scalar(s, n);
+    for (size_t i = 0;; i += 32) {
+        if (i + 32 > n) i = n - 32;
+        __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+        __m256i stop = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+            avx2_in_range(v, 0x00, 0x1f));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(stop);
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+        if (i + 32 == n) return n;
+    }
+}
+
+__attribute__((target("avx2")))
+static size_t url_safe_run_avx2(const char *s, size_t n) {
+    if (n < 32) return url_safe_run_scalar(s, n);
+    for (size_t i = 0;; i += 32) {
+        if (i + 32 > n) i = n - 32;
+        __m256i v = _mm256_loadu_si256((const __m256i *)(s + i));
+        __m256i ok = _mm256_or_si256(avx2_in_range(v, '0', 9), avx2_in_range(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 25));
+        ok = _mm256_or_si256(ok, _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('-')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('.'))));
+        ok = _mm256_or_si256(ok, _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('~'))));
+        unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(ok);
+        if (mask) return i + (size_t)__builtin_ctz(mask);
+        if (i + 32 == n) return n;
+    }
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static size_t json_plain_run_avx512(const char *s, size_t n) {
+    if (n < 64) return json_plain_run_avx2(s, n);
+    for (size_t i = 0;; i += 64) {
+        if (i + 64 > n) i = n - 64;
+        __m512i v = _mm512_loadu_si512((const void *)(s + i));
+        __mmask64 stop = _mm512_cmple_epu8_mask(v, _mm512_set1_epi8(0x1f))
+            | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('"'))
+            | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\\'));
+        if (stop) return i + (size_t)__builtin_ctzll(stop);
+        if (i + 64 == n) return n;
+    }
+}
+
+__attribute__((target("avx512f,avx512bw")))
+static size_t url_safe_run_avx512(const char *s, size_t n) {
+    if (n < 64) return url_safe_run_avx2(s, n);
+    for (size_t i = 0;; i += 64) {
+        if (i + 64 > n) i = n - 64;
+        __m512i v = _mm512_loadu_si512((const void *)(s + i));
+        __m512i letter = _mm512_or_si512(v, _mm512_set1_epi8(0x20));
+        __mmask64 ok = _mm512_cmple_epu8_mask(_mm512_sub_epi8(v, _mm512_set1_epi8('0')), _mm512_set1_epi8(9))
+            | _mm512_cmple_epu8_mask(_mm512_sub_epi8(letter, _mm512_set1_epi8('a')), _mm512_set1_epi8(25))
+            | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('-'))
+            | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('.'))
+            | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('_'))
+            | _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('~'));
+        if (~ok) return i + (size_t)__builtin_ctzll(~ok);
+        if (i + 64 == n) return n;
+    }
+}
+#endif
+
+static size_t (*json_plain_run)(const char *s, size_t n) = json_plain_run_scalar;
+static size_t (*url_safe_run)(const char *s, size_t n) = url_safe_run_scalar;
+
+static pthread_once_t cpu_once = PTHREAD_ONCE_INIT;
+static int cpu_level_supported = NLX402_CPU_SCALAR;
+static int cpu_level = NLX402_CPU_SCALAR;
+static const char *const cpu_level_names[] = { "scalar", "sse4.2", "avx2", "avx512" };
+
+static void cpu_select(int level) {
+    switch (level) {
+#if CPU_X86
+    case NLX402_CPU_AVX512:
+        json_plain_run = json_plain_run_avx512;
+        url_safe_run = url_safe_run_avx512;
+        break;
+    case NLX402_CPU_AVX2:
+        json_plain_run = json_plain_run_avx2;
+        url_safe_run = url_safe_run_avx2;
+        break;
+    case NLX402_CPU_SSE42:
+        json_plain_run = json_plain_run_sse42;
+        url_safe_run = url_safe_run_sse42;
+        break;
+#endif
+    default:
+        json_plain_run = json_plain_run_scalar;
+        url_safe_run = url_safe_run_scalar;
+        level = NLX402_CPU_SCALAR;
+    }
+    cpu_level = level;
+}
+
+static void cpu_init(void) {
+#if CPU_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) cpu_level_supported = NLX402_CPU_AVX512;
+    else if (__builtin_cpu_supports("avx2")) cpu_level_supported = NLX402_CPU_AVX2;
+    else if (__builtin_cpu_supports("sse4.2")) cpu_level_supported = NLX402_CPU_SSE42;
+#endif
+    int level = cpu_level_supported;
+    const char *env = getenv("NLX402_CPU");
+    for (int k = 0; env && k < level; k++) {
+        if (strcasecmp(env, cpu_level_names[k]) == 0) level = k;
+    }
+    cpu_select(level);
+}
+
+int nlx402_cpu_level(void) {
+    pthread_once(&cpu_once, cpu_init);
+    return cpu_level;
+}
+
+/* Forces the kernels to a level the CPU supports; meant for benchmarking,
+ * before any request is in flight. */
+int nlx402_set_cpu_level(int level) {
+    pthread_once(&cpu_once, cpu_init);
+    if (level < NLX402_CPU_SCALAR || level > cpu_level_supported) return -1;
+    cpu_select(level);
+    return 0;
+}
+
+/* Numbers are read and written here rather than with strtod and printf,
+ * which are slower and follow the locale's decimal point. Reading is exact
+ * on the fast path (Clinger: a mantissa below 2^53 scaled once by an exact
+ * power of ten rounds correctly); anything longer or further out goes to
+ * strtod with the decimal point swapped for the locale's. */
+#define NUM_MANTISSA_EXACT (1ULL << 53)
+#define NUM_TEXT_MAX 1024
+
+static const double num_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+static int num_parse_slow(const char *s, size_t len, double *out) {
+    char buf[NUM_TEXT_MAX];
+    if (len >= sizeof(buf)) return -1;
+    char point = localeconv()->decimal_point[0];
+    for (size_t i = 0; i < len; i++) buf[i] = s[i] == '.' ? point : s[i];
+    buf[len] = '\0';
+    char *end = NULL;
+    double v = strtod(buf, &end);
+    if (end != buf + len) return -1;
+    *out = v;
+    return 0;
+}
+
+/* Reads a JSON number spanning exactly len bytes. */
+static int json_number(const char *s, size_t len, double *out) {
+    const char *p = s;
+    const char *end = s + len;
+    int neg = p < end && *p == '-';
+    p += neg;
+
+    unsigned long long m = 0;
+    int exp10 = 0;
+    int digits = 0;
+    int dropped = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+        if (m < NUM_MANTISSA_EXACT) m = m * 10 + (unsigned long long)(*p - '0');
+        else exp10++, dropped |= *p != '0';
+    }
+    if (digits == 0) return -1;
+    if (p < end && *p == '.') {
+        const char *frac = ++p;
+        for (; p < end && *p >= '0' && *p <= '9'; p++) {
+            if (m < NUM_MANTISSA_EXACT) m = m * 10 + (unsigned long long)(*p - '0'), exp10--;
+            else dropped |= *p != '0';
+        }
+        if (p == frac) return -1;
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        int eneg = p < end && *p == '-';
+        p += eneg || (p < end && *p == '+');
+        const char *first = p;
+        int e = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++)
+            if (e < 100000) e = e * 10 + (*p - '0');
+        if (p == first) return -1;
+        exp10 += eneg ? -e : e;
+    }
+    if (p != end) return -1;
+
+    if (!dropped && m <= NUM_MANTISSA_EXACT) {
+        double v = (double)m;
+        if (m == 0) exp10 = 0;
+        /* 1234e25 is 1234000e22: shift zeros into the mantissa while it stays exact. */
+        while (exp10 > 22 && m * 10 <= NUM_MANTISSA_EXACT) m *= 10, exp10--, v = (double)m;
+        if (exp10 >= 0 && exp10 <= 22) {
+            *out = neg ? -(v * num_pow10[exp10]) : v * num_pow10[exp10];
+            return 0;
+        }
+        if (exp10 < 0 && exp10 >= -22) {
+            *out = neg ? -(v / num_pow10[-exp10]) : v / num_pow10[-exp10];
+            return 0;
+        }
+    }
+    return num_parse_slow(s, len, out);
+}
+
+/* Writes units with exactly decimals fraction digits; returns the length, or
+ * 0 if it does not fit in cap. */
+static size_t num_format_fixed(unsigned long long units, int decimals, char *out, size_t cap) {
+    char digits[NLX402_AMOUNT_MAX];
+    size_t n = 0;
+    do {
+        digits[n++] = (char)('0' + units % 10);
+        units /= 10;
+    } while (units);
+    while (n < (size_t)decimals + 1) digits[n++] = '0';
+
+    size_t len = n + (decimals > 0);
+    if (len + 1 > cap) return 0;
+    size_t pos = 0;
+    while (n > 0) {
+        if (n == (size_t)decimals) out[pos++] = '.';
+        out[pos++] = digits[--n];
+    }
+    out[pos] = '\0';
+    return pos;
+}
+
+static size_t num_format_slow(const char *fmt, double v, char *buf, size_t cap) {
+    int n = snprintf(buf, cap, fmt, v);
+    if (n < 0 || (size_t)n >= cap) return 0;
+    char point = localeconv()->decimal_point[0];
+    char *dot = point != '.' ? strchr(buf, point) : NULL;
+    if (dot) *dot = '.';
+    return (size_t)n;
+}
+
+/* Shortest fixed-point text that reads back as v: the fewest fraction
+ * digits k for which round(v * 10^k) / 10^k == v. Magnitudes outside
+ * [1e-7, 2^53) fall back to the fewest of 15 or 17 significant digits. */
+static int json_format_number(double v, char *buf, size_t cap) {
+    if (v != v || v - v != 0) return snprintf(buf, cap, "null");
+    double a = v < 0 ? -v : v;
+    size_t sign = v < 0;
+    if (cap < 2) return 0;
+    if (a >= 1e-7 && a < (double)NUM_MANTISSA_EXACT) {
+        for (int k = 0; k <= 17; k++) {
+            double scaled = a * num_pow10[k];
+            if (scaled >= (double)NUM_MANTISSA_EXACT) break;
+            unsigned long long m = (unsigned long long)(scaled + 0.5);
+            if ((double)m / num_pow10[k] != a) continue;
+            buf[0] = '-';
+            size_t n = num_format_fixed(m, k, buf + sign, cap - sign);
+            return n ? (int)(n + sign) : 0;
+        }
+    } else if (a == 0) {
+        return (int)num_format_fixed(0, 0, buf, cap);
+    }
+    size_t n = num_format_slow("%1.15g", v, buf, cap);
+    double back;
+    if (n == 0 || json_number(buf, n, &back) != 0 || back != v) n = num_format_slow("%1.17g", v, buf, cap);
+    return (int)n;
+}
+
+/* Writes a positive price with eight fraction digits, as %.8f would. The
+ * fraction is scaled on its own so the only rounding left is the final
+ * one, and values too close to a half to call go through printf. */
+static size_t num_format_price(double v, char *buf, size_t cap) {
+    if (v > 0 && v < 9e7) {
+        unsigned long long whole = (unsigned long long)v;
+        double scaled = (v - (double)whole) * 1e8;
+        unsigned long long frac = (unsigned long long)scaled;
+        double rem = scaled - (double)frac;
+        if (rem < 0.499999 || rem > 0.500001) {
+            frac += rem > 0.5;
+            return num_format_fixed(whole * 100000000ULL + frac, 8, buf, cap);
+        }
+    }
+    return num_format_slow("%.8f", v, buf, cap);
+}
+
+/* Response reader: a push parser that walks the body once and reports each
+ * value to a per-shape handler. The handler maps member names to small slot
+ * numbers; members it does not know (and everything under them) are skipped
+ * without being copied. String values are unescaped into a small buffer in
+ * the parser; a longer one moves into the handle's receive buffer, which a
+ * streamed body leaves unused, so token length is bounded only by what that
+ * buffer may grow to. */
+#define JSON_DEPTH_MAX 32
+#define JSON_TOKEN_INLINE 256
+
+/* The library backends parse a complete body, so theirs is buffered (with
+ * the zero padding yyjson needs to parse in place) rather than streamed. */
+#if defined(NLX402_JSON_YYJSON)
+#define JSON_STREAMING 0
+#define JSON_PADDING YYJSON_PADDING_SIZE
+#elif defined(NLX402_JSON_CJSON)
+#define JSON_STREAMING 0
+#define JSON_PADDING 1
+#else
+#define JSON_STREAMING 1
+#define JSON_PADDING 1
+#endif
+
+#define JSON_SKIP 0
+#define JSON_ROOT 1
+
+enum {
+    JSON_STRING,
+    JSON_NUMBER,
+    JSON_TRUE,
+    JSON_FALSE,
+    JSON_NULL,
+    JSON_OBJECT,
+    JSON_ARRAY
+};
+
+enum {
+    JS_VALUE,
+    JS_ARRAY_FIRST,
+    JS_OBJECT_FIRST,
+    JS_KEY,
+    JS_COLON,
+    JS_AFTER_VALUE,
+    JS_STRING,
+    JS_ESCAPE,
+    JS_UNICODE,
+    JS_NUMBER,
+    JS_LITERAL,
+    JS_DONE,
+    JS_ERROR
+};
+
+typedef struct {
+    /* Slot for member `key` of a container whose slot is `parent`. */
+    int (*key)(void *ctx, int parent, const char *key, size_t len);
+    /* A value in `slot`; index is its position when the slot is an array.
+     * s is NUL-terminated for strings and numbers. Returns -1 to abort. */
+    int (*value)(void *ctx, int slot, int index, int type, const char *s, size_t len);
+} JsonShape;
+
+typedef struct JsonParser {
+    const JsonShape *shape;
+    void *ctx;
+    int state;
+    int depth;
+    int slot[JSON_DEPTH_MAX];
+    int index[JSON_DEPTH_MAX];
+    unsigned char is_array[JSON_DEPTH_MAX];
+    int key_slot;
+    int value_slot;
+    int value_index;
+    int keep_raw;
+    int in_key;
+    int capture;
+    int overflow;
+    unsigned int unicode;
+    int unicode_digits;
+    unsigned int high_surrogate;
+    const char *literal;
+    int literal_type;
+    size_t literal_pos;
+    size_t len;
+    char *buf;
+    size_t cap;
+    struct Nlx402Handle *handle;    /* where long tokens go; NULL: none */
+    char small[JSON_TOKEN_INLINE];
+} JsonParser;
+
+static int recv_reserve(Nlx402Handle *h, size_t need) {
+    if (need <= h->recv_cap) return 0;
+    if (h->rt_violations) {
+        atomic_fetch_add_explicit(h->rt_violations, 1, memory_order_relaxed);
+        return -1;
+    }
+    size_t cap = h->recv_cap ? h->recv_cap : RECV_MIN_CAPACITY;
+    while (cap < need) {
+        if (cap > (size_t)-1 / 2) {
+            cap = need;
+            break;
+        }
+        cap *= 2;
+    }
+    char *ptr = (char *)mem_realloc(h->allocator, NLX402_MEM_RECV_BUFFERS, h->recv, cap);
+    if (!ptr) return -1;
+    h->recv = ptr;
+    h->recv_cap = cap;
+    return 0;
+}
+
+/* Request bodies and headers are written into a second per-handle buffer,
+ * kept across requests like the receive buffer. Its old contents are not
+ * preserved when it grows. */
+static char *send_reserve(Nlx402Handle *h, size_t need) {
+    if (need <= h->send_cap) return h->send;
+    if (h->rt_violations) {
+        atomic_fetch_add_explicit(h->rt_violations, 1, memory_order_relaxed);
+        return NULL;
+    }
+    size_t cap = h->send_cap ? h->send_cap : RECV_MIN_CAPACITY;
+    while (cap < need) cap = cap > (size_t)-1 / 2 ? need : cap * 2;
+    mem_free(h->allocator, h->send);
+    h->send = (char *)mem_alloc(h->allocator, NLX402_MEM_REQUESTS, cap);
+    h->send_cap = h->send ? cap : 0;
+    return h->send;
+}
+
+/* Writes s percent-encoded to out, which must have room for 3 * n bytes,
+ * copying runs of safe bytes in bulk. Returns the end of the output. */
+static char *url_encode(char *out, const char *s, size_t n) {
+    static const char hex[] = "0123456789ABCDEF";
+    size_t i = 0;
+    while (i < n) {
+        size_t run = url_safe_run(s + i, n - i);
+        memcpy(out, s + i, run);
+        out += run;
+        i += run;
+        if (i == n) break;
+        unsigned char c = (unsigned char)s[i++];
+        out[0] = '%';
+        out[1] = hex[c >> 4];
+        out[2] = hex[c & 0xf];
+        out += 3;
+    }
+    return out;
+}
+
+static int json_feed(JsonParser *p, const char *data, size_t n);
+
+static size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
+    size_t realsize = size * nmemb;
+    Nlx402Handle *h = (Nlx402Handle *)userp;
+
+    /* Successful bodies go straight into the response parser as they
+     * arrive, which leaves the receive buffer to its long tokens; error
+     * bodies and bodies the caller keeps are still buffered. */
+    if (JSON_STREAMING && h->parser && h->streaming == 0) {
+        long status = 0;
+        curl_easy_getinfo(h->curl, CURLINFO_RESPONSE_CODE, &status);
+        h->streaming = status >= 200 && status < 300 && !h->parser->keep_raw ? 1 : -1;
+        if (h->streaming > 0) h->parser->handle = h;
+    }
+    /* A body that is already malformed aborts the transfer. */
+    if (h->streaming > 0) {
+        return json_feed(h->parser, (const char *)contents, realsize) == 0 ? realsize : 0;
+    }
+
+    if (recv_reserve(h, h->recv_size + realsize + JSON_PADDING) != 0) {
+        return 0;
+    }
+
+    memcpy(&(h->recv[h->recv_size]), contents, realsize);
+    h->recv_size += realsize;
+    memset(h->recv + h->recv_size, 0, JSON_PADDING);
+
+    return realsize;
+}
+
+static size_t header_callback(char *buffer, size_t size, size_t nitems, void *userp) {
+    size_t realsize = size * nitems;
+    Nlx402Handle *h = (Nlx402Handle *)userp;
+    static const char name[] = "content-length:";
+
+    if (!(JSON_STREAMING && h->parser && !h->parser->keep_raw) && realsize > sizeof(name) - 1 && strncasecmp(buffer, name, sizeof(name) - 1) == 0) {
+        size_t length = 0;
+        size_t i = sizeof(name) - 1;
+        while (i < realsize && (buffer[i] == ' ' || buffer[i] == '\t')) i++;
+        /* Presizing stops at the retained size; a larger body still grows
+         * the buffer as it arrives. */
+        for (; i < realsize && buffer[i] >= '0' && buffer[i] <= '9'; i++) {
+            size_t d = (size_t)(buffer[i] - '0');
+            if (length > (RECV_RETAIN_MAX - d) / 10) {
+                length = RECV_RETAIN_MAX;
+                break;
+            }
+            length = length * 10 + d;
+        }
+        size_t need = h->recv_size + length + JSON_PADDING;
+        recv_reserve(h, need < RECV_RETAIN_MAX ? need : RECV_RETAIN_MAX);
+    }
+    return realsize;
+}
+
+/* Base58 works on base-58^5 groups: five digits fit a 32-bit limb, so
+ * decoding multiplies the whole number by 58^5 once per group instead of by
+ * 58 once per digit, and encoding divides by 58^5 once per input word. */
+#define B58_GROUP 656356768u
+
+static const char b58_alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+static const signed char b58_map[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1,  0,  1,  2,  3,  4,  5,  6,  7,  8, -1, -1, -1, -1, -1, -1,
+    -1,  9, 10, 11, 12, 13, 14, 15, 16, -1, 17, 18, 19, 20, 21, -1,
+    22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, -1, -1, -1, -1, -1,
+    -1, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, -1, 44, 45, 46,
+    47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+static const unsigned int b58_pow[6] = { 1u, 58u, 3364u, 195112u, 11316496u, 656356768u };
+
+/* Decodes exactly out_len bytes; the input must encode a value of that
+ * length, leading '1's included. Returns 0, or -1 if it does not. */
+int nlx402_base58_decode(const char *in, size_t len, unsigned char *out, size_t out_len) {
+    unsigned int limbs[(NLX402_BASE58_MAX_BYTES + 3) / 4] = {0};
+    size_t nlimbs = (out_len + 3) / 4;
+    if (!in || !out || out_len == 0 || out_len > NLX402_BASE58_MAX_BYTES) return -1;
+
+    size_t ones = 0;
+    while (ones < len && in[ones] == '1') ones++;
+    if (ones > out_len) return -1;
+
+    size_t i = ones;
+    size_t first = (len - ones) % 5;
+    while (i < len) {
+        size_t take = first ? first : 5;
+        first = 0;
+        unsigned int group = 0;
+        for (size_t k = 0; k < take; k++) {
+            int digit = b58_map[(unsigned char)in[i + k]];
+            if (digit < 0) return -1;
+            group = group * 58u + (unsigned int)digit;
+        }
+        i += take;
+
+        unsigned long long carry = group;
+        for (size_t j = 0; j < nlimbs; j++) {
+            unsigned long long t = (unsigned long long)limbs[j] * b58_pow[take] + carry;
+            limbs[j] = (unsigned int)t;
+            carry = t >> 32;
+        }
+        if (carry) return -1;
+    }
+    if ((out_len % 4) && (limbs[nlimbs - 1] >> (8 * (out_len % 4)))) return -1;
+
+    for (size_t b = 0; b < out_len; b++) {
+        size_t bit = out_len - 1 - b;
+        out[b] = (unsigned char)(limbs[bit / 4] >> (8 * (bit % 4)));
+    }
+
+    size_t zeros = 0;
+    while (zeros < out_len && out[zeros] == 0) zeros++;
+    return zeros == ones ? 0 : -1;
+}
+
+/* Writes the NUL-terminated encoding of in; returns its length, or 0 if it
+ * does not fit in cap. */
+size_t nlx402_base58_encode(const unsigned char *in, size_t len, char *out, size_t cap) {
+    unsigned int groups[(NLX402_BASE58_MAX_BYTES * 138 / 100 + 1) / 5 + 2];
+    size_t ngroups = 0;
+    if (!out || len > NLX402_BASE58_MAX_BYTES || (len && !in)) return 0;
+
+    size_t zeros = 0;
+    while (zeros < len && in[zeros] == 0) zeros++;
+
+    size_t i = zeros;
+    size_t head = (len - zeros) % 4;
+    while (i < len) {
+        size_t take = head ? head : 4;
+        head = 0;
+        unsigned int word = 0;
+        for (size_t k = 0; k < take; k++) word = (word << 8) | in[i + k];
+        i += take;
+
+        unsigned long long carry = word;
+        for (size_t j = 0; j < ngroups; j++) {
+            unsigned long long t = ((unsigned long long)groups[j] << (8 * take)) + carry;
+            groups[j] = (unsigned int)(t % B58_GROUP);
+            carry = t / B58_GROUP;
+        }
+        while (carry) {
+            groups[ngroups++] = (unsigned int)(carry % B58_GROUP);
+            carry /= B58_GROUP;
+        }
+    }
+
+    char digits[sizeof(groups) / sizeof(groups[0]) * 5];
+    size_t ndigits = 0;
+    for (size_t j = 0; j < ngroups; j++) {
+        unsigned int g = groups[j];
+        for (int k = 0; k < 5; k++) {
+            digits[ndigits++] = (char)(g % 58u);
+            g /= 58u;
+        }
+    }
+    while (ndigits > 0 && digits[ndigits - 1] == 0) ndigits--;
+
+    if (zeros + ndigits + 1 > cap) return 0;
+    size_t n = 0;
+    for (size_t k = 0; k < zeros; k++) out[n++] = '1';
+    while (ndigits > 0) out[n++] = b58_alphabet[(unsigned char)digits[--ndigits]];
+    out[n] = '\0';
+    return n;
+}
+
+/* Amounts are exact integers of base units. A plain integer string is
+ * already in base units; a string with a decimal point is in whole tokens and
+ * is scaled by 10^decimals. Fraction digits beyond decimals must be zero. */
+int nlx402_amount_parse(const char *s, int decimals, unsigned long long *out) {
+    if (!s || !out || decimals < 0 || decimals > NLX402_AMOUNT_DECIMALS_MAX) return -1;
+
+    unsigned long long v = 0;
+    int digits = 0;
+    int frac = -1;
+    for (const char *p = s; *p; p++) {
+        if (*p == '.' && frac < 0) {
+            frac = 0;
+            continue;
+        }
+        if (*p < '0' || *p > '9') return -1;
+        unsigned int d = (unsigned int)(*p - '0');
+        digits++;
+        if (frac >= 0) {
+            if (frac == decimals) {
+                if (d != 0) return -1;
+                continue;
+            }
+            frac++;
+        }
+        if (v > (~0ULL - d) / 10) return -1;
+        v = v * 10 + d;
+    }
+    if (digits == 0) return -1;
+
+    for (int k = frac; frac >= 0 && k < decimals; k++) {
+        if (v > ~0ULL / 10) return -1;
+        v *= 10;
+    }
+    *out = v;
+    return 0;
+}
+
+/* Writes units as a decimal with exactly decimals fraction digits; returns the
+ * length, or 0 if it does not fit in cap. */
+size_t nlx402_amount_format(unsigned long long units, int decimals, char *out, size_t cap) {
+    if (!out || decimals < 0 || decimals > NLX402_AMOUNT_DECIMALS_MAX) return 0;
+    return num_format_fixed(units, decimals, out, cap);
+}
+
+static int copy_inline(char *dst, size_t cap, const char *s) {
+    size_t len = strlen(s);
+    if (len >= cap) return 0;
+    memcpy(dst, s, len + 1);
+    return 1;
+}
+
+static char *dup_string(const Nlx402Allocator *a, int category, const char *s) {
+    if (!s) return NULL;
+    size_t len = strlen(s);
+    char *copy = (char *)(mem_alloc)(a, category, len + 1);
+    if (!copy) return NULL;
+    memcpy(copy, s, len + 1);
+    return copy;
+}
+
+#ifdef NLX402_ALLOC_TRACE
+/* Charged to the caller's line, not this helper's. */
+#define dup_string(a, category, s) \
+    ((s) ? alloc_trace_hit(__LINE__) : (void)0, dup_string((a), (category), (s)))
+#endif
+
+/* Low-cardinality response fields (chain, network, version, mints) are
+ * interned per client: equal values share one immutable string, so they can
+ * be compared by pointer and live until nlx402_client_cleanup. The values
+ * come from the server, so the table is capped in entries and string length;
+ * a value that does not get in is counted and copied into its response. */
+#define INTERN_INITIAL_CAPACITY 32
+#define NLX402_INTERN_LIMIT 1024
+#define NLX402_INTERN_LEN_MAX 256
+
+static unsigned int intern_hash(const char *s, size_t len) {
+    unsigned int h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static Nlx402InternEntry *intern_probe(Nlx402InternEntry *entries, size_t capacity,
+                                       unsigned int hash, const char *s, size_t len) {
+    size_t mask = capacity - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        Nlx402InternEntry *e = &entries[i];
+        if (!e->str) return e;
+        if (e->hash == hash && e->len == len && memcmp(e->str, s, len) == 0) return e;
+    }
+}
+
+static int intern_grow(Nlx402Client *client) {
+    Nlx402InternTable *t = &client->interns;
+    size_t capacity = t->capacity ? t->capacity * 2 : INTERN_INITIAL_CAPACITY;
+    Nlx402InternEntry *entries = (Nlx402InternEntry *)mem_calloc(&client->allocator, NLX402_MEM_CACHES, capacity, sizeof(*entries));
+    if (!entries) return -1;
+    for (size_t i = 0; i < t->capacity; i++) {
+        Nlx402InternEntry *e = &t->entries[i];
+        if (e->str) *intern_probe(entries, capacity, e->hash, e->str, e->len) = *e;
+    }
+    mem_free(&client->allocator, t->entries);
+    t->entries = entries;
+    t->capacity = capacity;
+    return 0;
+}
+
+/* Not logged: the values are the server's, and the counter reports them. */
+static const char *intern_reject(Nlx402Client *client) {
+    atomic_fetch_add_explicit(&client->interns.rejected, 1, memory_order_relaxed);
+    return NULL;
+}
+
+/* Returns NULL once the table is full; see nlx402_client_set_intern_limit. */
+const char *nlx402_client_intern(Nlx402Client *client, const char *s) {
+    if (!s) return NULL;
+    Nlx402InternTable *t = &client->interns;
+    size_t len = strlen(s);
+    unsigned int hash = intern_hash(s, len);
+    const char *found = NULL;
+
+    pthread_rwlock_rdlock(&t->lock);
+    if (t->capacity) found = intern_probe(t->entries, t->capacity, hash, s, len)->str;
+    pthread_rwlock_unlock(&t->lock);
+    if (found) return found;
+
+    if (len > NLX402_INTERN_LEN_MAX) return intern_reject(client);
+
+    pthread_rwlock_wrlock(&t->lock);
+    Nlx402InternEntry *e = t->capacity ? intern_probe(t->entries, t->capacity, hash, s, len) : NULL;
+    if (!e || !e->str) {
+        int full = t->count >= t->limit;
+        if (!full && (t->count + 1) * 2 > t->capacity) {
+            if (client->realtime) {
+                atomic_fetch_add_explicit(&client->rt_violations, 1, memory_order_relaxed);
+                full = 1;
+            } else if (intern_grow(client) != 0) {
+                pthread_rwlock_unlock(&t->lock);
+                return NULL;
+            }
+        }
+        if (full) {
+            pthread_rwlock_unlock(&t->lock);
+            return intern_reject(client);
+        }
+        e = intern_probe(t->entries, t->capacity, hash, s, len);
+    }
+    if (!e->str) {
+        char *copy = dup_string(&client->allocator, NLX402_MEM_CACHES, s);
+        if (copy) {
+            e->hash = hash;
+            e->len = len;
+            e->str = copy;
+            t->count++;
+        }
+    }
+    found = e->str;
+    pthread_rwlock_unlock(&t->lock);
+    return found;
+}
+
+/* At most limit distinct values are kept (0 restores the default); values
+ * turned away since init are counted by nlx402_client_intern_rejected. */
+void nlx402_client_set_intern_limit(Nlx402Client *client, size_t limit) {
+    pthread_rwlock_wrlock(&client->interns.lock);
+    client->interns.limit = limit ? limit : NLX402_INTERN_LIMIT;
+    pthread_rwlock_unlock(&client->interns.lock);
+}
+
+unsigned long long nlx402_client_intern_rejected(Nlx402Client *client) {
+    return atomic_load_explicit(&client->interns.rejected, memory_order_relaxed);
+}
+
+static void intern_release(Nlx402Client *client) {
+    Nlx402InternTable *t = &client->interns;
+    for (size_t i = 0; i < t->capacity; i++) {
+        if (t->entries[i].str) mem_free(&client->allocator, t->entries[i].str);
+    }
+    mem_free(&client->allocator, t->entries);
+    t->entries = NULL;
+    t->capacity = 0;
+    t->count = 0;
+    pthread_rwlock_destroy(&t->lock);
+}
+
+/* Wraps the client's allocator with a small header recording each block's
+ * size and category, so current, peak and allocation counts can be kept per
+ * client without the backing allocator's cooperation. */
+#define ACCT_HEADER 16
+
+static void acct_peak(atomic_size_t *peak, size_t now) {
+    size_t seen = atomic_load_explicit(peak, memory_order_relaxed);
+    while (now > seen &&
+           !atomic_compare_exchange_weak_explicit(peak, &seen, now, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+/* Claims size bytes before the backing allocator is asked, so concurrent
+ * calls cannot all pass the limit and overshoot it together: the fetch-add
+ * on the total decides, and a call that took it past the limit gives its
+ * bytes back and fails. Callers undo a claim with acct_sub. */
+static int acct_reserve(Nlx402MemAccount *m, int category, size_t size) {
+    size_t limit = atomic_load_explicit(&m->limit, memory_order_relaxed);
+    size_t now = atomic_fetch_add_explicit(&m->current[NLX402_MEM_CATEGORIES], size, memory_order_relaxed) + size;
+    if (limit && now > limit) {
+        atomic_fetch_sub_explicit(&m->current[NLX402_MEM_CATEGORIES], size, memory_order_relaxed);
+        return -1;
+    }
+    acct_peak(&m->peak[NLX402_MEM_CATEGORIES], now);
+    now = atomic_fetch_add_explicit(&m->current[category], size, memory_order_relaxed) + size;
+    acct_peak(&m->peak[category], now);
+    return 0;
+}
+
+static void acct_sub(Nlx402MemAccount *m, int category, size_t size) {
+    atomic_fetch_sub_explicit(&m->current[category], size, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&m->current[NLX402_MEM_CATEGORIES], size, memory_order_relaxed);
+}
+
+/* In real-time mode the backing pool is the client's reserve, so a failure
+ * there is this client's pool miss; the depot's own count covers libcurl's
+ * misses too. */
+static void *acct_refused(Nlx402MemAccount *m) {
+    if (m->rt_violations) atomic_fetch_add_explicit(m->rt_violations, 1, memory_order_relaxed);
+    return NULL;
+}
+
+static void *acct_malloc(void *ctx, size_t size) {
+    Nlx402MemAccount *m = (Nlx402MemAccount *)ctx;
+    int category = mem_category;
+    if (size > (size_t)-1 - ACCT_HEADER || acct_reserve(m, category, size) != 0) return NULL;
+
+    unsigned char *raw = (unsigned char *)m->backing.malloc_fn(m->backing.ctx, ACCT_HEADER + size);
+    if (!raw) {
+        acct_sub(m, category, size);
+        return acct_refused(m);
+    }
+    ((size_t *)raw)[0] = size;
+    ((size_t *)raw)[1] = (size_t)category;
+    atomic_fetch_add_explicit(&m->allocs[category], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&m->allocs[NLX402_MEM_CATEGORIES], 1, memory_order_relaxed);
+    return raw + ACCT_HEADER;
+}
+
+static void *acct_realloc(void *ctx, void *ptr, size_t size) {
+    Nlx402MemAccount *m = (Nlx402MemAccount *)ctx;
+    if (!ptr) return acct_malloc(ctx, size);
+
+    unsigned char *raw = (unsigned char *)ptr - ACCT_HEADER;
+    size_t old_size = ((size_t *)raw)[0];
+    int category = (int)((size_t *)raw)[1];
+    if (size > (size_t)-1 - ACCT_HEADER) return NULL;
+    if (size > old_size && acct_reserve(m, category, size - old_size) != 0) return NULL;
+
+    raw = (unsigned char *)m->backing.realloc_fn(m->backing.ctx, raw, ACCT_HEADER + size);
+    if (!raw) {
+        if (size > old_size) acct_sub(m, category, size - old_size);
+        return acct_refused(m);
+    }
+    ((size_t *)raw)[0] = size;
+    if (size < old_size) acct_sub(m, category, old_size - size);
+    return raw + ACCT_HEADER;
+}
+
+static void acct_free(void *ctx, void *ptr) {
+    Nlx402MemAccount *m = (Nlx402MemAccount *)ctx;
+    if (!ptr) return;
+    unsigned char *raw = (unsigned char *)ptr - ACCT_HEADER;
+    acct_sub(m, (int)((size_t *)raw)[1], ((size_t *)raw)[0]);
+    m->backing.free_fn(m->backing.ctx, raw);
+}
+
+static void acct_init(Nlx402MemAccount *m, Nlx402Allocator *out, const Nlx402Allocator *backing) {
+    m->backing = *backing;
+    m->rt_violations = NULL;
+    atomic_init(&m->limit, 0);
+    for (int i = 0; i <= NLX402_MEM_CATEGORIES; i++) {
+        atomic_init(&m->current[i], 0);
+        atomic_init(&m->peak[i], 0);
+        atomic_init(&m->allocs[i], 0);
+    }
+    out->malloc_fn = acct_malloc;
+    out->realloc_fn = acct_realloc;
+    out->free_fn = acct_free;
+    out->ctx = m;
+}
+
+static void acct_read(Nlx402MemAccount *m, int slot, Nlx402MemCounter *out) {
+    out->current = atomic_load_explicit(&m->current[slot], memory_order_relaxed);
+    out->peak = atomic_load_explicit(&m->peak[slot], memory_order_relaxed);
+    out->allocs = atomic_load_explicit(&m->allocs[slot], memory_order_relaxed);
+}
+
+void nlx402_client_mem_stats(Nlx402Client *client, Nlx402MemStats *out) {
+    acct_read(&client->accounting, NLX402_MEM_CATEGORIES, &out->total);
+    for (int i = 0; i < NLX402_MEM_CATEGORIES; i++) {
+        acct_read(&client->accounting, i, &out->by_category[i]);
+    }
+}
+
+/* Allocations that would take the client past limit bytes fail; 0 lifts it. */
+void nlx402_client_set_mem_limit(Nlx402Client *client, size_t limit) {
+    atomic_store_explicit(&client->accounting.limit, limit, memory_order_relaxed);
+}
+
+static Nlx402Handle *acquire_handle(Nlx402Client *client) {
+    pthread_mutex_lock(&client->handles_lock);
+    Nlx402Handle *h = client->idle_handles;
+    if (h) client->idle_handles = h->next;
+    pthread_mutex_unlock(&client->handles_lock);
+
+    if (h) {
+        if (client->rt_pool) pool_enter(client->rt_pool);
+        curl_easy_reset(h->curl);
+    } else if (client->realtime) {
+        atomic_fetch_add_explicit(&client->rt_violations, 1, memory_order_relaxed);
+        return NULL;
+    } else {
+        h = (Nlx402Handle *)mem_calloc(&client->allocator, NLX402_MEM_CACHES, 1, sizeof(*h));
+        if (!h) return NULL;
+        h->allocator = &client->allocator;
+        h->curl = curl_easy_init();
+        if (!h->curl) {
+            fprintf(stderr, "curl_easy_init failed\n");
+            mem_free(&client->allocator, h);
+            return NULL;
+        }
+    }
+
+    h->next = NULL;
+    h->recv_size = 0;
+    if (recv_reserve(h, RECV_MIN_CAPACITY) == 0) h->recv[0] = '\0';
+    return h;
+}
+
+static void release_handle(Nlx402Client *client, Nlx402Handle *h) {
+    if (!h) return;
+    if (h->recv_cap > RECV_RETAIN_MAX && !h->rt_violations) {
+        mem_free(h->allocator, h->recv);
+        h->recv = NULL;
+        h->recv_cap = 0;
+    }
+    if (h->send_cap > RECV_RETAIN_MAX && !h->rt_violations) {
+        mem_free(h->allocator, h->send);
+        h->send = NULL;
+        h->send_cap = 0;
+    }
+    h->recv_size = 0;
+
+    pthread_mutex_lock(&client->handles_lock);
+    h->next = client->idle_handles;
+    client->idle_handles = h;
+    pthread_mutex_unlock(&client->handles_lock);
+    if (client->rt_pool) pool_leave();
+}
+
+static void destroy_handles(Nlx402Client *client) {
+    Nlx402Handle *h = client->idle_handles;
+    while (h) {
+        Nlx402Handle *next = h->next;
+        curl_easy_cleanup(h->curl);
+        if (!h->rt_violations) {
+            mem_free(h->allocator, h->recv);
+            mem_free(h->allocator, h->send);
+            mem_free(h->allocator, h);
+        }
+        h = next;
+    }
+    client->idle_handles = NULL;
+
+    if (client->rt_slab) {
+        if (client->rt_locked) munlock(client->rt_slab, client->rt_slab_size);
+        mem_free(&default_allocator, client->rt_slab);
+        client->rt_slab = NULL;
+    }
+    pthread_mutex_destroy(&client->handles_lock);
+
+    /* Lifts real-time mode's hold on the pool: the client's blocks are all
+     * back by now, short of responses the caller has not freed. */
+    if (client->rt_pool) {
+        pool_reserve_retire(client->rt_pool);
+        client->rt_pool = NULL;
+        client->accounting.backing.ctx = NULL;
+    }
+}
+
+void nlx402_client_init_with_allocator(
+    Nlx402Client *client,
+    const char *base_url,
+    const char *api_key,
+    const Nlx402Allocator *allocator
+) {
+#if defined(NLX402_JSON_CJSON)
+    pthread_once(&cjson_hooks_once, install_cjson_hooks);
+#endif
+    pthread_once(&cpu_once, cpu_init);
+
+    acct_init(&client->accounting, &client->allocator, allocator ? allocator : &pool_allocator);
+    memset(&client->interns, 0, sizeof(client->interns));
+    pthread_rwlock_init(&client->interns.lock, NULL);
+    client->interns.limit = NLX402_INTERN_LIMIT;
+    atomic_init(&client->interns.rejected, 0);
+    pthread_mutex_init(&client->handles_lock, NULL);
+    client->idle_handles = NULL;
+    client->realtime = 0;
+    atomic_init(&client->rt_violations, 0);
+    client->rt_slab = NULL;
+    client->rt_slab_size = 0;
+    client->rt_locked = 0;
+    client->rt_pool = NULL;
+    client->base_url = dup_string(&client->allocator, NLX402_MEM_CLIENT, base_url ? base_url : "https://pay.thrt.ai");
+    client->api_key  = api_key ? dup_string(&client->allocator, NLX402_MEM_CLIENT, api_key) : NULL;
+
+    size_t len = strlen(client->base_url);
+    while (len > 0 && client->base_url[len - 1] == '/') {
+        client->base_url[len - 1] = '\0';
+        len--;
+    }
+}
+
+void nlx402_client_init(Nlx402Client *client, const char *base_url, const char *api_key) {
+    nlx402_client_init_with_allocator(client, base_url, api_key, NULL);
+}
+
+void nlx402_client_set_api_key(Nlx402Client *client, const char *api_key) {
+    if (client->api_key) mem_free(&client->allocator, client->api_key);
+    client->api_key = api_key ? dup_string(&client->allocator, NLX402_MEM_CLIENT, api_key) : NULL;
+}
+
+void nlx402_client_cleanup(Nlx402Client *client) {
+    if (client->base_url) mem_free(&client->allocator, client->base_url);
+    if (client->api_key) mem_free(&client->allocator, client->api_key);
+    intern_release(client);
+    destroy_handles(client);
+}
+
+/* Performs the request on a pooled handle. On success the body is left in
+ * the handle's receive buffer; the caller parses it in place and hands the
+ * handle back with release_handle. */
+static int perform_with(
+    Nlx402Client *client,
+    const Nlx402Allocator *a,
+    const char *path,
+    const char *method,
+    int require_api_key,
+    struct curl_slist *extra_headers,
+    const char *body,
+    JsonParser *parser,
+    long *out_status,
+    Nlx402Handle **out_handle
+) {
+    CURLcode res;
+    int retval = -1;
+
+    /* A caller that wrote its request into a handle's send buffer passes that
+     * handle in *out_handle; it is released here on failure either way. */
+    Nlx402Handle *h = *out_handle ? *out_handle : acquire_handle(client);
+    *out_handle = NULL;
+    if (!h) return -1;
+    CURL *curl = h->curl;
+    h->parser = parser;
+    h->streaming = 0;
+
+    size_t url_len = strlen(client->base_url) + strlen(path) + 1;
+    char *url = (char *)mem_alloc(a, NLX402_MEM_REQUESTS, url_len);
+    if (!url) {
+        release_handle(client, h);
+        return -1;
+    }
+    snprintf(url, url_len, "%s%s", client->base_url, path);
+
+    curl_easy_setopt(curl, CURLOPT_URL, url);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)h);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_callback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, (void *)h);
+
+    if (strcmp(method, "GET") == 0) {
+        curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    } else if (strcmp(method, "POST") == 0) {
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        if (body) {
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body);
+        }
+    } else {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method);
+        if (body) {
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, body);
+        }
+    }
+
+    /* Header nodes come from the client allocator rather than
+     * curl_slist_append; the extra header strings are only borrowed. */
+    struct curl_slist *headers = NULL;
+    char *api_header = NULL;
+    if (require_api_key) {
+        if (!client->api_key) {
+            fprintf(stderr, "NLx402: API key is required but not set.\n");
+            mem_free(a, url);
+            release_handle(client, h);
+            return -1;
+        }
+        size_t api_header_len = strlen("x-api-key: ") + strlen(client->api_key) + 1;
+        api_header = (char *)mem_alloc(a, NLX402_MEM_REQUESTS, api_header_len);
+        if (!api_header) goto cleanup;
+        snprintf(api_header, api_header_len, "x-api-key: %s", client->api_key);
+    }
+
+    size_t header_count = api_header ? 1 : 0;
+    for (struct curl_slist *tmp = extra_headers; tmp; tmp = tmp->next) header_count++;
+
+    if (header_count > 0) {
+        headers = (struct curl_slist *)mem_calloc(a, NLX402_MEM_REQUESTS, header_count, sizeof(struct curl_slist));
+        if (!headers) goto cleanup;
+        size_t i = 0;
+        if (api_header) headers[i++].data = api_header;
+        for (struct curl_slist *tmp = extra_headers; tmp; tmp = tmp->next) {
+            headers[i++].data = tmp->data;
+        }
+        for (i = 0; i + 1 < header_count; i++) headers[i].next = &headers[i + 1];
+    }
+
+    if (headers) {
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    }
+
+    res = curl_easy_perform(curl);
+    if (res != CURLE_OK) {
+        fprintf(stderr, "curl_easy_perform() failed: %s\n", curl_easy_strerror(res));
+        retval = -1;
+        goto cleanup;
+    }
+
+    long status_code = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status_code);
+    if (out_status) *out_status = status_code;
+
+    if (status_code < 200 || status_code >= 300) {
+        fprintf(stderr, "NLx402 request failed with status %ld, body: %s\n",
+                status_code, h->recv ? h->recv : "");
+        retval = -1;
+        goto cleanup;
+    }
+
+    if (!h->recv && !parser) {
+        retval = -1;
+        goto cleanup;
+    }
+
+    *out_handle = h;
+    h = NULL;
+    retval = 0;
+
+cleanup:
+    /* The handle outlives the header nodes, failed or aborted transfers
+     * included, so curl must not keep pointing at them. */
+    if (headers) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, NULL);
+    mem_free(a, headers);
+    mem_free(a, api_header);
+    mem_free(a, url);
+    if (h) release_handle(client, h);
+    return retval;
+}
+
+
+/* Real-time mode: everything the payment path needs is allocated here, up
+ * front, and afterwards any request that would have to grow a handle pool,
+ * receive buffer, intern table or pool class fails and is counted instead.
+ * Must be called before the client is shared between threads, and needs the
+ * default pooled allocator for the client and, through nlx402_global_init_mem,
+ * for libcurl, so that libcurl's own allocations during the client's requests
+ * draw on the client's reserve too. Other clients keep the ordinary pool. */
+int nlx402_client_enable_realtime(Nlx402Client *client, const Nlx402RealtimeConfig *cfg) {
+    if (!client || !cfg || cfg->handles <= 0 || client->realtime) return -1;
+    if (client->accounting.backing.malloc_fn != pool_malloc) {
+        fprintf(stderr, "NLx402: real-time mode requires the default pooled allocator\n");
+        return -1;
+    }
+    if (curl_allocator.malloc_fn != pool_malloc) {
+        fprintf(stderr, "NLx402: real-time mode requires nlx402_global_init_mem with nlx402_pool_allocator()\n");
+        return -1;
+    }
+
+    size_t handle_size = (sizeof(Nlx402Handle) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    size_t recv_cap = cfg->recv_capacity ? cfg->recv_capacity : RECV_MIN_CAPACITY;
+    recv_cap = (recv_cap + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    size_t send_cap = cfg->send_capacity ? cfg->send_capacity : RECV_MIN_CAPACITY;
+    send_cap = (send_cap + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    size_t stride = handle_size + recv_cap + send_cap;
+    size_t slab_size = (size_t)cfg->handles * stride;
+
+    unsigned char *slab = (unsigned char *)mem_alloc(&default_allocator, NLX402_MEM_CACHES, slab_size);
+    if (!slab) return -1;
+    memset(slab, 0, slab_size);
+    if (cfg->lock_memory && mlock(slab, slab_size) != 0) {
+        fprintf(stderr, "NLx402: mlock of %zu bytes failed\n", slab_size);
+        mem_free(&default_allocator, slab);
+        return -1;
+    }
+
+    while ((client->interns.count + cfg->intern_capacity) * 2 > client->interns.capacity) {
+        if (intern_grow(client) != 0) goto fail;
+    }
+
+    for (int i = 0; i < cfg->handles; i++) {
+        Nlx402Handle *h = (Nlx402Handle *)(slab + (size_t)i * stride);
+        h->curl = curl_easy_init();
+        if (!h->curl) goto fail;
+        h->allocator = &client->allocator;
+        h->recv = (char *)h + handle_size;
+        h->recv_cap = recv_cap;
+        h->send = h->recv + recv_cap;
+        h->send_cap = send_cap;
+        h->rt_violations = &client->rt_violations;
+    }
+
+    PoolReserve *pool = pool_reserve_create(cfg->pool_blocks_per_class,
+                                            cfg->pool_max_block ? cfg->pool_max_block : 16 * 1024,
+                                            cfg->lock_memory);
+    if (!pool) goto fail;
+
+    /* Pooled handles made before this point keep their growable buffers;
+     * retire them so only preallocated ones remain. */
+    pthread_mutex_lock(&client->handles_lock);
+    Nlx402Handle *old = client->idle_handles;
+    client->idle_handles = NULL;
+    for (int i = 0; i < cfg->handles; i++) {
+        Nlx402Handle *h = (Nlx402Handle *)(slab + (size_t)i * stride);
+        h->next = client->idle_handles;
+        client->idle_handles = h;
+    }
+    pthread_mutex_unlock(&client->handles_lock);
+    while (old) {
+        Nlx402Handle *next = old->next;
+        curl_easy_cleanup(old->curl);
+        mem_free(old->allocator, old->recv);
+        mem_free(old->allocator, old->send);
+        mem_free(old->allocator, old);
+        old = next;
+    }
+
+    client->rt_slab = slab;
+    client->rt_slab_size = slab_size;
+    client->rt_locked = cfg->lock_memory;
+    client->rt_pool = pool;
+    client->accounting.backing.ctx = pool;
+    client->accounting.rt_violations = &client->rt_violations;
+    client->realtime = 1;
+    return 0;
+
+fail:
+    for (int i = 0; i < cfg->handles; i++) {
+        Nlx402Handle *h = (Nlx402Handle *)(slab + (size_t)i * stride);
+        if (h->curl) curl_easy_cleanup(h->curl);
+    }
+    if (cfg->lock_memory) munlock(slab, slab_size);
+    mem_free(&default_allocator, slab);
+    return -1;
+}
+
+/* Counts this client's misses only; nlx402_pool_stats reports rejections
+ * across the process, libcurl's included. */
+unsigned long long nlx402_realtime_violations(Nlx402Client *client) {
+    return atomic_load_explicit(&client->rt_violations, memory_order_relaxed);
+}
+
+
+int nlx402_request(
+    Nlx402Client *client,
+    const char *path,
+    const char *method,
+    int require_api_key,
+    struct curl_slist *extra_headers,
+    const char *body,
+    long *out_status,
+    MemoryChunk *out_chunk
+) {
+    Nlx402Handle *h = NULL;
+    int rc = perform_with(client, &client->allocator, path, method, require_api_key,
+                          extra_headers, body, NULL, out_status, &h);
+    if (rc != 0) return rc;
+
+    /* The body is the caller's, from plain malloc, so free() releases it. */
+    if (out_chunk) {
+        out_chunk->size = h->recv_size;
+        out_chunk->data = (char *)malloc(h->recv_size + 1);
+        if (!out_chunk->data) rc = -1;
+        else memcpy(out_chunk->data, h->recv, h->recv_size + 1);
+    }
+    release_handle(client, h);
+    return rc;
+}
+
+void nlx402_free_chunk(MemoryChunk *chunk) {
+    if (!chunk) return;
+    free(chunk->data);
+    chunk->data = NULL;
+    chunk->size = 0;
+}
+
+
+static void json_init(JsonParser *p, const JsonShape *shape, void *ctx) {
+    p->shape = shape;
+    p->ctx = ctx;
+    p->state = JS_VALUE;
+    p->depth = 0;
+    p->high_surrogate = 0;
+    p->keep_raw = 0;
+    p->buf = p->small;
+    p->cap = sizeof(p->small);
+    p->handle = NULL;
+}
+
+static int json_is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static int json_grow(JsonParser *p, size_t need) {
+    Nlx402Handle *h = p->handle;
+    if (!h) return -1;
+    /* Still in the inline buffer, or already in recv and moved with it. */
+    int inline_buf = p->buf == p->small;
+    if (recv_reserve(h, need) != 0) return -1;
+    if (inline_buf) memcpy(h->recv, p->buf, p->len);
+    p->buf = h->recv;
+    p->cap = h->recv_cap;
+    return 0;
+}
+
+static void json_append(JsonParser *p, const char *s, size_t n) {
+    if (!p->capture || p->overflow) return;
+    if (p->len + n >= p->cap && json_grow(p, p->len + n + 1) != 0) {
+        p->overflow = 1;
+        return;
+    }
+    memcpy(p->buf + p->len, s, n);
+    p->len += n;
+}
+
+static int json_emit(JsonParser *p, int type, const char *s, size_t len) {
+    if (p->value_slot == JSON_SKIP) return 0;
+    return p->shape->value(p->ctx, p->value_slot, p->value_index, type, s, len);
+}
+
+/* A value is starting: work out which slot it belongs to. */
+static void json_begin_value(JsonParser *p) {
+    if (p->depth == 0) {
+        p->value_slot = JSON_ROOT;
+        p->value_index = -1;
+    } else if (p->is_array[p->depth - 1]) {
+        p->value_slot = p->slot[p->depth - 1];
+        p->value_index = p->index[p->depth - 1]++;
+    } else {
+        p->value_slot = p->key_slot;
+        p->value_index = -1;
+    }
+}
+
+static void json_end_value(JsonParser *p) {
+    p->state = p->depth == 0 ? JS_DONE : JS_AFTER_VALUE;
+}
+
+static int json_push(JsonParser *p, int is_array) {
+    if (p->depth == JSON_DEPTH_MAX) return -1;
+    if (json_emit(p, is_array ? JSON_ARRAY : JSON_OBJECT, NULL, 0) != 0) return -1;
+    /* Containers inside arrays are opaque to the shapes. */
+    p->slot[p->depth] = p->value_index >= 0 ? JSON_SKIP : p->value_slot;
+    p->index[p->depth] = 0;
+    p->is_array[p->depth] = (unsigned char)is_array;
+    p->depth++;
+    p->state = is_array ? JS_ARRAY_FIRST : JS_OBJECT_FIRST;
+    return 0;
+}
+
+static void json_begin_string(JsonParser *p, int in_key) {
+    p->in_key = in_key;
+    p->capture = in_key ? p->slot[p->depth - 1] != JSON_SKIP : p->value_slot != JSON_SKIP;
+    p->overflow = 0;
+    p->len = 0;
+    p->state = JS_STRING;
+}
+
+static int json_end_string(JsonParser *p) {
+    if (p->high_surrogate) return -1;
+    p->buf[p->len] = '\0';
+    if (p->in_key) {
+        int parent = p->slot[p->depth - 1];
+        p->key_slot = parent == JSON_SKIP || p->overflow ? JSON_SKIP
+                    : p->shape->key(p->ctx, parent, p->buf, p->len);
+        p->state = JS_COLON;
+        return 0;
+    }
+    if (p->capture && p->overflow) return -1;
+    if (json_emit(p, JSON_STRING, p->buf, p->len) != 0) return -1;
+    json_end_value(p);
+    return 0;
+}
+
+static size_t utf8_encode(unsigned int cp, char *out) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xc0 | (cp >> 6));
+        out[1] = (char)(0x80 | (cp & 0x3f));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xe0 | (cp >> 12));
+        out[1] = (char)(0x80 | ((cp >> 6) & 0x3f));
+        out[2] = (char)(0x80 | (cp & 0x3f));
+        return 3;
+    }
+    out[0] = (char)(0xf0 | (cp >> 18));
+    out[1] = (char)(0x80 | ((cp >> 12) & 0x3f));
+    out[2] = (char)(0x80 | ((cp >> 6) & 0x3f));
+    out[3] = (char)(0x80 | (cp & 0x3f));
+    return 4;
+}
+
+static void json_append_utf8(JsonParser *p, unsigned int cp) {
+    char out[4];
+    json_append(p, out, utf8_encode(cp, out));
+}
+
+static int json_end_unicode(JsonParser *p) {
+    unsigned int cp = p->unicode;
+    if (p->high_surrogate) {
+        if (cp < 0xdc00 || cp > 0xdfff) return -1;
+        cp = 0x10000 + ((p->high_surrogate - 0xd800) << 10) + (cp - 0xdc00);
+        p->high_surrogate = 0;
+    } else if (cp >= 0xd800 && cp <= 0xdbff) {
+        p->high_surrogate = cp;
+        return 0;
+    } else if (cp >= 0xdc00 && cp <= 0xdfff) {
+        return -1;
+    }
+    json_append_utf8(p, cp);
+    return 0;
+}
+
+static int json_end_number(JsonParser *p) {
+    /* -?(0|[1-9]d*)(.d+)?([eE][+-]?d+)? */
+    const char *s = p->buf;
+    const char *end = p->buf + p->len;
+    if (p->overflow) return -1;
+    p->buf[p->len] = '\0';
+    if (s < end && *s == '-') s++;
+    if (s == end) return -1;
+    if (*s == '0') s++;
+    else if (*s >= '1' && *s <= '9') while (s < end && *s >= '0' && *s <= '9') s++;
+    else return -1;
+    if (s < end && *s == '.') {
+        const char *digits = ++s;
+        while (s < end && *s >= '0' && *s <= '9') s++;
+        if (s == digits) return -1;
+    }
+    if (s < end && (*s == 'e' || *s == 'E')) {
+        s++;
+        if (s < end && (*s == '+' || *s == '-')) s++;
+        const char *digits = s;
+        while (s < end && *s >= '0' && *s <= '9') s++;
+        if (s == digits) return -1;
+    }
+    if (s != end) return -1;
+    if (json_emit(p, JSON_NUMBER, p->buf, p->len) != 0) return -1;
+    json_end_value(p);
+    return 0;
+}
+
+static int json_start_value(JsonParser *p, char c) {
+    json_begin_value(p);
+    switch (c) {
+    case '{': return json_push(p, 0);
+    case '[': return json_push(p, 1);
+    case '"':
+        json_begin_string(p, 0);
+        return 0;
+    case 't': p->literal = "true"; p->literal_type = JSON_TRUE; break;
+    case 'f': p->literal = "false"; p->literal_type = JSON_FALSE; break;
+    case 'n': p->literal = "null"; p->literal_type = JSON_NULL; break;
+    default:
+        if (c != '-' && (c < '0' || c > '9')) return -1;
+        p->capture = 1;
+        p->overflow = 0;
+        p->len = 0;
+        json_append(p, &c, 1);
+        p->state = JS_NUMBER;
+        return 0;
+    }
+    p->literal_pos = 1;
+    p->state = JS_LITERAL;
+    return 0;
+}
+
+static int json_close(JsonParser *p, char c) {
+    if (p->depth == 0 || p->is_array[p->depth - 1] != (c == ']')) return -1;
+    p->depth--;
+    json_end_value(p);
+    return 0;
+}
+
+static int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/* Consumes n more bytes of the document. Returns -1 once it is malformed or a
+ * handler has failed; the parser stays failed afterwards. */
+static int json_feed(JsonParser *p, const char *data, size_t n) {
+    size_t i = 0;
+    int rc = 0;
+    if (p->state == JS_ERROR) return -1;
+    while (i < n && rc == 0) {
+        char c = data[i];
+        switch (p->state) {
+        case JS_STRING: {
+            size_t start = i;
+            i += json_plain_run(data + i, n - i);
+            if (i > start) {
+                if (p->high_surrogate) {
+                    rc = -1;
+                    break;
+                }
+                json_append(p, data + start, i - start);
+            }
+            if (i == n) continue;
+            c = data[i];
+            if (c == '"') rc = json_end_string(p);
+            else if (c == '\\') p->state = JS_ESCAPE;
+            else rc = -1;
+            break;
+        }
+        case JS_ESCAPE:
+            if (p->high_surrogate && c != 'u') {
+                rc = -1;
+                break;
+            }
+            p->state = JS_STRING;
+            switch (c) {
+            case '"': case '\\': case '/': json_append(p, &c, 1); break;
+            case 'b': json_append(p, "\b", 1); break;
+            case 'f': json_append(p, "\f", 1); break;
+            case 'n': json_append(p, "\n", 1); break;
+            case 'r': json_append(p, "\r", 1); break;
+            case 't': json_append(p, "\t", 1); break;
+            case 'u':
+                p->unicode = 0;
+                p->unicode_digits = 0;
+                p->state = JS_UNICODE;
+                break;
+            default: rc = -1;
+            }
+            break;
+        case JS_UNICODE: {
+            int v = hex_value(c);
+            if (v < 0) {
+                rc = -1;
+                break;
+            }
+            p->unicode = (p->unicode << 4) | (unsigned int)v;
+            if (++p->unicode_digits == 4) {
+                rc = json_end_unicode(p);
+                p->state = JS_STRING;
+            }
+            break;
+        }
+        case JS_NUMBER:
+            if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+                json_append(p, &c, 1);
+                break;
+            }
+            rc = json_end_number(p);
+            continue;   /* c ends the number and is read again */
+        case JS_LITERAL:
+            if (c != p->literal[p->literal_pos]) {
+                rc = -1;
+                break;
+            }
+            if (p->literal[++p->literal_pos] == '\0') {
+                rc = json_emit(p, p->literal_type, NULL, 0);
+                json_end_value(p);
+            }
+            break;
+        default:
+            if (json_is_space(c)) break;
+            switch (p->state) {
+            case JS_VALUE:
+                rc = json_start_value(p, c);
+                break;
+            case JS_ARRAY_FIRST:
+                rc = c == ']' ? json_close(p, c) : json_start_value(p, c);
+                break;
+            case JS_OBJECT_FIRST:
+                if (c == '}') rc = json_close(p, c);
+                else if (c == '"') json_begin_string(p, 1);
+                else rc = -1;
+                break;
+            case JS_KEY:
+                if (c == '"') json_begin_string(p, 1);
+                else rc = -1;
+                break;
+            case JS_COLON:
+                if (c == ':') p->state = JS_VALUE;
+                else rc = -1;
+                break;
+            case JS_AFTER_VALUE:
+                if (c == ',') p->state = p->is_array[p->depth - 1] ? JS_VALUE : JS_KEY;
+                else if (c == '}' || c == ']') rc = json_close(p, c);
+                else rc = -1;
+                break;
+            default:
+                rc = -1;
+            }
+        }
+        i++;
+    }
+    if (rc != 0) p->state = JS_ERROR;
+    return p->state == JS_ERROR ? -1 : 0;
+}
+
+#if JSON_STREAMING
+static int json_finish(JsonParser *p) {
+    if (p->state == JS_NUMBER && p->depth == 0 && json_end_number(p) != 0) p->state = JS_ERROR;
+    return p->state == JS_DONE ? 0 : -1;
+}
+#endif
+
+#if defined(NLX402_JSON_CJSON)
+/* Replays a cJSON tree as the events the built-in reader would produce. */
+static int cjson_emit(JsonParser *p, const cJSON *item, int slot, int index) {
+    if (slot == JSON_SKIP) return 0;
+    if (cJSON_IsString(item)) {
+        return p->shape->value(p->ctx, slot, index, JSON_STRING, item->valuestring, strlen(item->valuestring));
+    }
+    if (cJSON_IsNumber(item)) {
+        char num[32];
+        int n = json_format_number(item->valuedouble, num, sizeof(num));
+        return p->shape->value(p->ctx, slot, index, JSON_NUMBER, num, (size_t)n);
+    }
+    if (cJSON_IsBool(item)) return p->shape->value(p->ctx, slot, index, cJSON_IsTrue(item) ? JSON_TRUE : JSON_FALSE, NULL, 0);
+    if (cJSON_IsNull(item)) return p->shape->value(p->ctx, slot, index, JSON_NULL, NULL, 0);
+
+    int is_array = cJSON_IsArray(item);
+    if (!is_array && !cJSON_IsObject(item)) return 0;
+    if (p->shape->value(p->ctx, slot, index, is_array ? JSON_ARRAY : JSON_OBJECT, NULL, 0) != 0) return -1;
+    if (index >= 0) return 0;
+    int i = 0;
+    for (const cJSON *child = item->child; child; child = child->next, i++) {
+        int child_slot = is_array ? slot : p->shape->key(p->ctx, slot, child->string, strlen(child->string));
+        if (cjson_emit(p, child, child_slot, is_array ? i : -1) != 0) return -1;
+    }
+    return 0;
+}
+#elif defined(NLX402_JSON_YYJSON)
+static int yyjson_emit(JsonParser *p, yyjson_val *val, int slot, int index) {
+    if (slot == JSON_SKIP) return 0;
+    switch (yyjson_get_type(val)) {
+    case YYJSON_TYPE_STR:
+        return p->shape->value(p->ctx, slot, index, JSON_STRING, yyjson_get_str(val), yyjson_get_len(val));
+    case YYJSON_TYPE_RAW: {
+        /* Numbers are read as raw text so the handlers see exactly what
+         * was sent. */
+        char num[64];
+        size_t n = yyjson_get_len(val);
+        if (n >= sizeof(num)) return -1;
+        memcpy(num, yyjson_get_raw(val), n);
+        num[n] = '\0';
+        return p->shape->value(p->ctx, slot, index, JSON_NUMBER, num, n);
+    }
+    case YYJSON_TYPE_BOOL:
+        return p->shape->value(p->ctx, slot, index, yyjson_is_true(val) ? JSON_TRUE : JSON_FALSE, NULL, 0);
+    case YYJSON_TYPE_NULL:
+        return p->shape->value(p->ctx, slot, index, JSON_NULL, NULL, 0);
+    case YYJSON_TYPE_ARR: {
+        if (p->shape->value(p->ctx, slot, index, JSON_ARRAY, NULL, 0) != 0) return -1;
+        if (index >= 0) return 0;
+        size_t i, max;
+        yyjson_val *item;
+        yyjson_arr_foreach(val, i, max, item) {
+            if (yyjson_emit(p, item, slot, (int)i) != 0) return -1;
+        }
+        return 0;
+    }
+    case YYJSON_TYPE_OBJ: {
+        if (p->shape->value(p->ctx, slot, index, JSON_OBJECT, NULL, 0) != 0) return -1;
+        if (index >= 0) return 0;
+        size_t i, max;
+        yyjson_val *key, *item;
+        yyjson_obj_foreach(val, i, max, key, item) {
+            int child_slot = p->shape->key(p->ctx, slot, yyjson_get_str(key), yyjson_get_len(key));
+            if (yyjson_emit(p, item, child_slot, -1) != 0) return -1;
+        }
+        return 0;
+    }
+    default:
+        return 0;
+    }
+}
+#endif
+
+/* Completes a response read through perform_with: the built-in reader has
+ * already seen the body, the library backends parse the buffered one now. */
+static int json_read_finish(JsonParser *p, Nlx402Handle *h, const Nlx402Allocator *a) {
+#if defined(NLX402_JSON_CJSON)
+    const Nlx402Allocator *prev = cjson_enter(a);
+    cJSON *root = cJSON_ParseWithLength(h->recv, h->recv_size);
+    int rc = root ? cjson_emit(p, root, JSON_ROOT, -1) : -1;
+    cJSON_Delete(root);
+    cjson_leave(prev);
+    return rc;
+#elif defined(NLX402_JSON_YYJSON)
+    yyjson_alc alc = yyjson_allocator(a);
+    yyjson_doc *doc = yyjson_read_opts(h->recv, h->recv_size, YYJSON_READ_INSITU | YYJSON_READ_NUMBER_AS_RAW, &alc, NULL);
+    int rc = doc ? yyjson_emit(p, yyjson_doc_get_root(doc), JSON_ROOT, -1) : -1;
+    yyjson_doc_free(doc);
+    return rc;
+#else
+    (void)h;
+    (void)a;
+    return json_finish(p);
+#endif
+}
+
+/* A body the caller keeps is buffered rather than streamed; the built-in
+ * reader reads it from the caller's copy, so recv can still take long
+ * tokens. */
+static int json_read_kept(JsonParser *p, Nlx402Handle *h, const Nlx402Allocator *a, const char *body, size_t len) {
+    if (JSON_STREAMING) {
+        p->handle = h;
+        if (json_feed(p, body, len) != 0) return -1;
+    }
+    return json_read_finish(p, h, a);
+}
+
+static size_t json_string_size(const char *s) {
+    size_t n = 2;
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\' || c == '\b' || c == '\f' || c == '\n' || c == '\r' || c == '\t') n += 2;
+        else if (c < 0x20) n += 6;
+        else n++;
+    }
+    return n;
+}
+
+static char *json_put_string(char *out, const char *s) {
+    static const char hex[] = "0123456789abcdef";
+    size_t n = strlen(s);
+    *out++ = '"';
+    for (const char *end = s + n; s < end; s++) {
+        size_t run = json_plain_run(s, (size_t)(end - s));
+        memcpy(out, s, run);
+        out += run;
+        s += run;
+        if (s == end) break;
+        unsigned char c = (unsigned char)*s;
+        char esc = 0;
+        switch (c) {
+        case '"': esc = '"'; break;
+        case '\\': esc = '\\'; break;
+        case '\b': esc = 'b'; break;
+        case '\f': esc = 'f'; break;
+        case '\n': esc = 'n'; break;
+        case '\r': esc = 'r'; break;
+        case '\t': esc = 't'; break;
+        }
+        if (esc) {
+            *out++ = '\\';
+            *out++ = esc;
+        } else if (c < 0x20) {
+            memcpy(out, "\\u00", 4);
+            out[4] = hex[c >> 4];
+            out[5] = hex[c & 0xf];
+            out += 6;
+        } else {
+            *out++ = (char)c;
+        }
+    }
+    *out++ = '"';
+    return out;
+}
+
+static int json_int(int type, const char *s, size_t len) {
+    double v;
+    if (type != JSON_NUMBER || json_number(s, len, &v) != 0) return 0;
+    if (v >= 2147483647.0) return 2147483647;
+    if (v <= -2147483648.0) return -2147483647 - 1;
+    return (int)v;
+}
+
+
+static int string_list_add(const Nlx402Allocator *a, const char ***list, int *count, int *cap, const char *s) {
+    if (*count == *cap) {
+        int grown = *cap ? *cap * 2 : 4;
+        const char **items = (const char **)mem_realloc(a, NLX402_MEM_RESPONSES, (void *)*list, (size_t)grown * sizeof(char *));
+        if (!items) return -1;
+        *list = items;
+        *cap = grown;
+    }
+    (*list)[(*count)++] = s;
+    return 0;
+}
+
+/* Response schemas. Each response type has one table of its wire members:
+ * FIELD(slot, parent, name, kind, member) for a scalar or string,
+ * SEQ(slot, parent, name, kind, member, count) for a member stored with a
+ * length, and OBJECT(slot, parent, name) for a nested object whose members
+ * name its slot as their parent. The tables expand to the slot numbers and
+ * to arrays of descriptors that one reader, free, copy, hash and writer
+ * below walk at run time, so a member is added, parsed, freed and written by
+ * adding one line. */
+enum {
+    F_BOOL,         /* int, true or not */
+    F_INT,          /* int */
+    F_NUMBER,       /* double */
+    F_OWNED,        /* char * */
+    F_INTERN,       /* const char * from the client's intern table, or owned */
+    F_INLINE,       /* char[], oversized values clear fits */
+    F_LIST,         /* const char ** of interned (or owned) strings, int count */
+    F_BLOB,         /* char * with a size_t length; kept, never parsed */
+    F_OBJECT
+};
+
+typedef struct {
+    const char *name;
+    unsigned char len;
+    unsigned char kind;
+    unsigned char slot;
+    unsigned char parent;
+    unsigned short offset;
+    unsigned short size;
+    unsigned short count;   /* offset of the count or length for SEQ */
+} ResponseField;
+
+typedef struct {
+    const ResponseField *fields;
+    int count;
+    size_t size;
+    size_t allocator;       /* offset of the allocator pointer, 0 if none */
+    size_t owned;           /* offset of the owned mask, 0 if none */
+} ResponseSchema;
+
+#define METADATA_FIELDS(FIELD, SEQ, OBJECT) \
+    FIELD(M_OK, JSON_ROOT, "ok", F_BOOL, ok) \
+    OBJECT(M_METADATA, JSON_ROOT, "metadata") \
+    SEQ(M_MINTS, JSON_ROOT, "supported_mints", F_LIST, supported_mints, supported_mints_count) \
+    FIELD(M_NETWORK, M_METADATA, "network", F_INTERN, network) \
+    FIELD(M_VERSION, M_METADATA, "version", F_INTERN, version) \
+    SEQ(M_CHAINS, M_METADATA, "supported_chains", F_LIST, supported_chains, supported_chains_count)
+
+#define AUTH_ME_FIELDS(FIELD, SEQ, OBJECT) \
+    FIELD(A_OK, JSON_ROOT, "ok", F_BOOL, ok) \
+    FIELD(A_CREATED_AT, JSON_ROOT, "created_at", F_NUMBER, created_at) \
+    FIELD(A_WALLET_ID, JSON_ROOT, "wallet_id", F_OWNED, wallet_id) \
+    FIELD(A_SELECTED_MINT, JSON_ROOT, "selected_mint", F_INTERN, selected_mint)
+
+#define QUOTE_FIELDS(FIELD, SEQ, OBJECT) \
+    FIELD(Q_AMOUNT, JSON_ROOT, "amount", F_OWNED, amount) \
+    FIELD(Q_CHAIN, JSON_ROOT, "chain", F_INTERN, chain) \
+    FIELD(Q_DECIMALS, JSON_ROOT, "decimals", F_INT, decimals) \
+    FIELD(Q_EXPIRES_AT, JSON_ROOT, "expires_at", F_NUMBER, expires_at) \
+    FIELD(Q_MINT, JSON_ROOT, "mint", F_INLINE, mint) \
+    FIELD(Q_NETWORK, JSON_ROOT, "network", F_INTERN, network) \
+    FIELD(Q_NONCE, JSON_ROOT, "nonce", F_INLINE, nonce) \
+    FIELD(Q_RECIPIENT, JSON_ROOT, "recipient", F_INLINE, recipient) \
+    FIELD(Q_VERSION, JSON_ROOT, "version", F_INTERN, version) \
+    SEQ(Q_RAW, JSON_SKIP, "raw", F_BLOB, raw, raw_len)
+
+#define VERIFY_FIELDS(FIELD, SEQ, OBJECT) \
+    FIELD(V_OK, JSON_ROOT, "ok", F_BOOL, ok)
+
+#define PAID_ACCESS_FIELDS(FIELD, SEQ, OBJECT) \
+    FIELD(P_OK, JSON_ROOT, "ok", F_BOOL, ok) \
+    OBJECT(P_X402, JSON_ROOT, "x402") \
+    FIELD(P_AMOUNT, P_X402, "amount", F_OWNED, amount) \
+    FIELD(P_DECIMALS, P_X402, "decimals", F_INT, decimals) \
+    FIELD(P_MINT, P_X402, "mint", F_INLINE, mint) \
+    FIELD(P_NONCE, P_X402, "nonce", F_INLINE, nonce) \
+    FIELD(P_STATUS, P_X402, "status", F_OWNED, status) \
+    FIELD(P_TX, P_X402, "tx", F_INLINE, tx) \
+    FIELD(P_VERSION, P_X402, "version", F_INTERN, version)
+
+#define SCHEMA_SLOT(slot, ...) slot,
+#define SCHEMA_FIELD(slot, parent, name, kind, member) \
+    { name, sizeof(name) - 1, kind, slot, parent, offsetof(SCHEMA_TYPE, member), sizeof(((SCHEMA_TYPE *)0)->member), 0 },
+#define SCHEMA_SEQ(slot, parent, name, kind, member, count) \
+    { name, sizeof(name) - 1, kind, slot, parent, offsetof(SCHEMA_TYPE, member), 0, offsetof(SCHEMA_TYPE, count) },
+#define SCHEMA_OBJECT(slot, parent, name) \
+    { name, sizeof(name) - 1, F_OBJECT, slot, parent, 0, 0, 0 },
+#define SCHEMA_FIELDS(table) table(SCHEMA_FIELD, SCHEMA_SEQ, SCHEMA_OBJECT)
+#define SCHEMA_COUNT(fields) ((int)(sizeof(fields) / sizeof(fields[0])))
+
+/* Slots are numbered in table order, so a slot indexes its descriptor. */
+enum { METADATA_SLOTS = JSON_ROOT, METADATA_FIELDS(SCHEMA_SLOT, SCHEMA_SLOT, SCHEMA_SLOT) };
+enum { AUTH_ME_SLOTS = JSON_ROOT, AUTH_ME_FIELDS(SCHEMA_SLOT, SCHEMA_SLOT, SCHEMA_SLOT) };
+enum { QUOTE_SLOTS = JSON_ROOT, QUOTE_FIELDS(SCHEMA_SLOT, SCHEMA_SLOT, SCHEMA_SLOT) };
+enum { VERIFY_SLOTS = JSON_ROOT, VERIFY_FIELDS(SCHEMA_SLOT, SCHEMA_SLOT, SCHEMA_SLOT) };
+enum { PAID_ACCESS_SLOTS = JSON_ROOT, PAID_ACCESS_FIELDS(SCHEMA_SLOT, SCHEMA_SLOT, SCHEMA_SLOT) };
+
+#define SCHEMA_TYPE MetadataResponse
+static const ResponseField metadata_fields[] = { SCHEMA_FIELDS(METADATA_FIELDS) };
+#undef SCHEMA_TYPE
+#define SCHEMA_TYPE AuthMeResponse
+static const ResponseField auth_me_fields[] = { SCHEMA_FIELDS(AUTH_ME_FIELDS) };
+#undef SCHEMA_TYPE
+#define SCHEMA_TYPE QuoteResponse
+static const ResponseField quote_fields[] = { SCHEMA_FIELDS(QUOTE_FIELDS) };
+#undef SCHEMA_TYPE
+#define SCHEMA_TYPE VerifyResponse
+static const ResponseField verify_fields[] = { SCHEMA_FIELDS(VERIFY_FIELDS) };
+#undef SCHEMA_TYPE
+#define SCHEMA_TYPE PaidAccessResponse
+static const ResponseField paid_access_fields[] = { SCHEMA_FIELDS(PAID_ACCESS_FIELDS) };
+#undef SCHEMA_TYPE
+
+static const ResponseSchema metadata_schema = {
+    metadata_fields, SCHEMA_COUNT(metadata_fields), sizeof(MetadataResponse), offsetof(MetadataResponse, allocator),
+    offsetof(MetadataResponse, owned)
+};
+static const ResponseSchema auth_me_schema = {
+    auth_me_fields, SCHEMA_COUNT(auth_me_fields), sizeof(AuthMeResponse), offsetof(AuthMeResponse, allocator),
+    offsetof(AuthMeResponse, owned)
+};
+static const ResponseSchema quote_schema = {
+    quote_fields, SCHEMA_COUNT(quote_fields), sizeof(QuoteResponse), offsetof(QuoteResponse, allocator),
+    offsetof(QuoteResponse, owned)
+};
+static const ResponseSchema verify_schema = {
+    verify_fields, SCHEMA_COUNT(verify_fields), sizeof(VerifyResponse), 0, 0
+};
+static const ResponseSchema paid_access_schema = {
+    paid_access_fields, SCHEMA_COUNT(paid_access_fields), sizeof(PaidAccessResponse), offsetof(PaidAccessResponse, allocator),
+    offsetof(PaidAccessResponse, owned)
+};
+
+#define RESPONSE_FIELDS_MAX 16
+
+typedef struct {
+    const ResponseSchema *schema;
+    Nlx402Client *client;
+    void *out;
+    const Nlx402Allocator *allocator;
+    int fits;
+    int list_cap[RESPONSE_FIELDS_MAX];
+    unsigned char seen[RESPONSE_FIELDS_MAX];
+} ResponseParse;
+
+static const Nlx402Allocator *response_allocator(const ResponseSchema *sc, const void *r) {
+    if (!sc->allocator) return NULL;
+    return *(const Nlx402Allocator *const *)((const char *)r + sc->allocator);
+}
+
+/* Clears out and sets up r to parse into it. */
+static void response_parse_init(ResponseParse *r, const ResponseSchema *sc, Nlx402Client *client, void *out,
+                                const Nlx402Allocator *a) {
+    memset(out, 0, sc->size);
+    if (sc->allocator) *(const Nlx402Allocator **)((char *)out + sc->allocator) = a;
+    memset(r, 0, sizeof(*r));
+    r->schema = sc;
+    r->client = client;
+    r->out = out;
+    r->allocator = a;
+    r->fits = 1;
+}
+
+static int response_is_owned(const ResponseSchema *sc, const void *r, int i) {
+    return sc->owned && (*(const unsigned int *)((const char *)r + sc->owned) >> i & 1u);
+}
+
+/* Turns every item of list field i into a copy the response owns. If one
+ * cannot be copied the rest are dropped, so the list never mixes the two. */
+static int response_own_list(const ResponseSchema *sc, const Nlx402Allocator *a, void *r, int i) {
+    const ResponseField *f = &sc->fields[i];
+    const char **items = *(const char ***)((char *)r + f->offset);
+    int count = *(const int *)((char *)r + f->count);
+    *(unsigned int *)((char *)r + sc->owned) |= 1u << i;
+    for (int k = 0; k < count; k++) {
+        if (items[k] && !(items[k] = dup_string(a, NLX402_MEM_RESPONSES, items[k]))) {
+            while (++k < count) items[k] = NULL;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* The interned string for field i, or, when the table is full or s is too
+ * long to intern, a copy owned by the response and marked in its owned mask.
+ * Once one item of a list is a copy, the whole list is. */
+static const char *response_intern(const ResponseSchema *sc, Nlx402Client *client, const Nlx402Allocator *a,
+                                   void *r, int i, const char *s) {
+    if (!response_is_owned(sc, r, i)) {
+        const char *v = nlx402_client_intern(client, s);
+        if (v || !sc->owned) return v;
+        if (sc->fields[i].kind == F_LIST) {
+            if (response_own_list(sc, a, r, i) != 0) return NULL;
+        } else {
+            *(unsigned int *)((char *)r + sc->owned) |= 1u << i;
+        }
+    }
+    return dup_string(a, NLX402_MEM_RESPONSES, s);
+}
+
+/* Member names match case-insensitively and the first occurrence of a
+ * member wins, whatever its kind, as with cJSON_GetObjectItem. */
+static int response_key(void *ctx, int parent, const char *k, size_t len) {
+    const ResponseParse *r = (const ResponseParse *)ctx;
+    const ResponseSchema *sc = r->schema;
+    /* Members of a repeated object are skipped with it. */
+    if (parent > JSON_ROOT && r->seen[parent - JSON_ROOT - 1] > 1) return JSON_SKIP;
+    for (int i = 0; i < sc->count; i++) {
+        const ResponseField *f = &sc->fields[i];
+        if (f->parent == parent && f->len == len && strncasecmp(f->name, k, len) == 0) return f->slot;
+    }
+    return JSON_SKIP;
+}
+
+static int response_value(void *ctx, int slot, int index, int type, const char *s, size_t len) {
+    ResponseParse *r = (ResponseParse *)ctx;
+    if (slot <= JSON_ROOT) return 0;
+    int i = slot - JSON_ROOT - 1;
+    const ResponseField *f = &r->schema->fields[i];
+    char *field = (char *)r->out + f->offset;
+
+    if (index < 0 && r->seen[i] < 2) r->seen[i]++;
+    if (r->seen[i] > 1) return 0;
+    if (f->kind == F_LIST) {
+        if (index < 0) return 0;
+        const char *item = type == JSON_STRING ? response_intern(r->schema, r->client, r->allocator, r->out, i, s) : NULL;
+        if (type == JSON_STRING && !item) return -1;
+        if (string_list_add(r->allocator, (const char ***)field, (int *)((char *)r->out + f->count),
+                            &r->list_cap[i], item) == 0) return 0;
+        if (response_is_owned(r->schema, r->out, i)) mem_free(r->allocator, (void *)item);
+        return -1;
+    }
+    if (index >= 0) return 0;
+    switch (f->kind) {
+    case F_BOOL:
+        *(int *)field = type == JSON_TRUE;
+        break;
+    case F_INT:
+        if (type == JSON_NUMBER) *(int *)field = json_int(type, s, len);
+        break;
+    case F_NUMBER:
+        if (type == JSON_NUMBER && json_number(s, len, (double *)field) != 0) *(double *)field = 0;
+        break;
+    case F_OWNED:
+        if (type == JSON_STRING) {
+            *(char **)field = dup_string(r->allocator, NLX402_MEM_RESPONSES, s);
+            if (!*(char **)field) return -1;
+        }
+        break;
+    case F_INTERN:
+        if (type == JSON_STRING) {
+            *(const char **)field = response_intern(r->schema, r->client, r->allocator, r->out, i, s);
+            if (!*(const char **)field) return -1;
+        }
+        break;
+    case F_INLINE:
+        if (type == JSON_STRING) r->fits &= copy_inline(field, f->size, s);
+        break;
+    }
+    return 0;
+}
+
+static const JsonShape response_shape = { response_key, response_value };
+
+static int response_owns(int kind) {
+    return kind == F_OWNED || kind == F_LIST || kind == F_BLOB;
+}
+
+static void response_free(const ResponseSchema *sc, void *r) {
+    const Nlx402Allocator *a = allocator_or_default(response_allocator(sc, r));
+    for (int i = 0; i < sc->count; i++) {
+        const ResponseField *f = &sc->fields[i];
+        if (!response_owns(f->kind) && f->kind != F_INTERN) continue;
+        void *owned = *(void **)((char *)r + f->offset);
+        if (response_is_owned(sc, r, i)) {
+            if (f->kind == F_INTERN) mem_free(a, owned);
+            for (int k = 0; f->kind == F_LIST && k < *(const int *)((char *)r + f->count); k++) {
+                mem_free(a, (void *)((const char **)owned)[k]);
+            }
+        }
+        if (response_owns(f->kind) && owned) mem_free(a, owned);
+    }
+    /* Emptied, so a failed call can be freed again by its caller. */
+    memset(r, 0, sc->size);
+}
+
+/* Deep copy into client: owned strings, lists and the raw body are
+ * duplicated with the client's allocator and interned strings are interned
+ * again in its table (or copied, as when parsed), so the copy depends only
+ * on client, whatever arena, caller buffer or client the source came from. */
+static int response_copy(const ResponseSchema *sc, Nlx402Client *client, void *dst, const void *src) {
+    if (!client || !dst || !src || dst == src) return -1;
+    const Nlx402Allocator *a = &client->allocator;
+    memcpy(dst, src, sc->size);
+    if (sc->allocator) *(const Nlx402Allocator **)((char *)dst + sc->allocator) = a;
+    if (sc->owned) *(unsigned int *)((char *)dst + sc->owned) = 0;
+    for (int i = 0; i < sc->count; i++) {
+        if (response_owns(sc->fields[i].kind)) *(void **)((char *)dst + sc->fields[i].offset) = NULL;
+    }
+    for (int i = 0; i < sc->count; i++) {
+        const ResponseField *f = &sc->fields[i];
+        if (f->kind == F_INTERN) {
+            const char **field = (const char **)((char *)dst + f->offset);
+            if (*field && !(*field = response_intern(sc, client, a, dst, i, *field))) {
+                response_free(sc, dst);
+                return -1;
+            }
+        }
+        if (!response_owns(f->kind)) continue;
+        const void *from = *(void *const *)((const char *)src + f->offset);
+        if (!from) continue;
+        size_t n;
+        if (f->kind == F_OWNED) n = strlen((const char *)from) + 1;
+        else if (f->kind == F_LIST) n = (size_t)*(const int *)((const char *)src + f->count) * sizeof(char *);
+        else n = *(const size_t *)((const char *)src + f->count) + 1;
+        if (n == 0) continue;
+        void *copy = mem_alloc(a, NLX402_MEM_RESPONSES, n);
+        if (!copy) {
+            response_free(sc, dst);
+            return -1;
+        }
+        memcpy(copy, from, n);
+        *(void **)((char *)dst + f->offset) = copy;
+        if (f->kind == F_LIST) {
+            /* Copying the list's own items covers the rest of it. */
+            const char **items = (const char **)copy;
+            for (size_t k = 0; k < n / sizeof(char *) && !response_is_owned(sc, dst, i); k++) {
+                const char *v = items[k] ? nlx402_client_intern(client, items[k]) : NULL;
+                if (v) {
+                    items[k] = v;
+                } else if (items[k] && (!sc->owned || response_own_list(sc, a, dst, i) != 0)) {
+                    response_free(sc, dst);
+                    return -1;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static unsigned long long hash_bytes(unsigned long long h, const void *p, size_t n) {
+    const unsigned char *b = (const unsigned char *)p;
+    for (size_t i = 0; i < n; i++) {
+        h ^= b[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static unsigned long long hash_string(unsigned long long h, const char *s) {
+    if (!s) return hash_bytes(h, "\xff", 1);
+    return hash_bytes(h, s, strlen(s) + 1);
+}
+
+/* FNV-1a over the wire members in table order; equal responses hash equal
+ * whichever client, allocator or raw bytes they came with. */
+static unsigned long long response_hash(const ResponseSchema *sc, const void *r) {
+    unsigned long long h = 14695981039346656037ULL;
+    for (int i = 0; i < sc->count; i++) {
+        const ResponseField *f = &sc->fields[i];
+        const char *field = (const char *)r + f->offset;
+        switch (f->kind) {
+        case F_BOOL:
+        case F_INT:
+            h = hash_bytes(h, field, sizeof(int));
+            break;
+        case F_NUMBER: {
+            double v = *(const double *)field;
+            if (v == 0) v = 0;
+            h = hash_bytes(h, &v, sizeof(v));
+            break;
+        }
+        case F_OWNED:
+        case F_INTERN:
+            h = hash_string(h, *(const char *const *)field);
+            break;
+        case F_INLINE:
+            h = hash_string(h, field);
+            break;
+        case F_LIST: {
+            const char *const *items = *(const char *const *const *)field;
+            int count = *(const int *)((const char *)r + f->count);
+            h = hash_bytes(h, &count, sizeof(count));
+            for (int k = 0; k < count; k++) h = hash_string(h, items[k]);
+            break;
+        }
+        }
+    }
+    return h;
+}
+
+/* Output for the writer: bytes past cap are counted but not written, so the
+ * same pass measures. */
+typedef struct {
+    char *buf;
+    size_t cap;
+    size_t len;
+} TextOut;
+
+static void text_put(TextOut *o, const char *s, size_t n) {
+    if (o->len + n <= o->cap) memcpy(o->buf + o->len, s, n);
+    o->len += n;
+}
+
+static void text_put_string(TextOut *o, const char *s) {
+    size_t n = json_string_size(s);
+    if (o->len + n <= o->cap) json_put_string(o->buf + o->len, s);
+    o->len += n;
+}
+
+static void text_put_number(TextOut *o, double v) {
+    char num[32];
+    int n = json_format_number(v, num, sizeof(num));
+    text_put(o, num, n > 0 ? (size_t)n : 0);
+}
+
+/* Writes the members under parent as an object, in table order. Missing
+ * strings are written as empty ones. */
+static void response_write_object(const ResponseSchema *sc, const char *r, int parent, TextOut *o) {
+    int first = 1;
+    text_put(o, "{", 1);
+    for (int i = 0; i < sc->count; i++) {
+        const ResponseField *f = &sc->fields[i];
+        const char *field = r + f->offset;
+        if (f->parent != parent || f->kind == F_BLOB) continue;
+        if (!first) text_put(o, ",", 1);
+        first = 0;
+        text_put_string(o, f->name);
+        text_put(o, ":", 1);
+        switch (f->kind) {
+        case F_BOOL:
+            if (*(const int *)field) text_put(o, "true", 4);
+            else text_put(o, "false", 5);
+            break;
+        case F_INT:
+            text_put_number(o, *(const int *)field);
+            break;
+        case F_NUMBER:
+            text_put_number(o, *(const double *)field);
+            break;
+        case F_OWNED:
+        case F_INTERN: {
+            const char *str = *(const char *const *)field;
+            text_put_string(o, str ? str : "");
+            break;
+        }
+        case F_INLINE:
+            text_put_string(o, field);
+            break;
+        case F_LIST: {
+            const char *const *items = *(const char *const *const *)field;
+            int count = *(const int *)(r + f->count);
+            text_put(o, "[", 1);
+            for (int k = 0; k < count; k++) {
+                if (k > 0) text_put(o, ",", 1);
+                if (items[k]) text_put_string(o, items[k]);
+                else text_put(o, "null", 4);
+            }
+            text_put(o, "]", 1);
+            break;
+        }
+        case F_OBJECT:
+            response_write_object(sc, r, f->slot, o);
+            break;
+        }
+    }
+    text_put(o, "}", 1);
+}
+
+/* Writes r as JSON and a NUL into buf; returns the length, or 0 if it does
+ * not fit in cap. With buf NULL it only returns the length. */
+static size_t response_write(const ResponseSchema *sc, const void *r, char *buf, size_t cap) {
+    TextOut o = { buf, buf && cap ? cap - 1 : 0, 0 };
+    response_write_object(sc, (const char *)r, JSON_ROOT, &o);
+    if (!buf) return o.len;
+    if (o.len >= cap) return 0;
+    buf[o.len] = '\0';
+    return o.len;
+}
+
+#define RESPONSE_API(name, Type, schema) \
+    int nlx402_copy_##name(Nlx402Client *client, Type *dst, const Type *src) { \
+        return response_copy(&schema, client, dst, src); \
+    } \
+    unsigned long long nlx402_hash_##name(const Type *r) { return response_hash(&schema, r); } \
+    size_t nlx402_write_##name(const Type *r, char *buf, size_t cap) { return response_write(&schema, r, buf, cap); }
+
+RESPONSE_API(metadata, MetadataResponse, metadata_schema)
+RESPONSE_API(auth_me, AuthMeResponse, auth_me_schema)
+RESPONSE_API(quote, QuoteResponse, quote_schema)
+RESPONSE_API(paid_access, PaidAccessResponse, paid_access_schema)
+
+void nlx402_free_metadata(MetadataResponse *m);
+
+int nlx402_get_metadata(Nlx402Client *client, MetadataResponse *out) {
+    long status;
+    Nlx402Handle *h = NULL;
+
+    ResponseParse m;
+    response_parse_init(&m, &metadata_schema, client, out, &client->allocator);
+    JsonParser parser;
+    json_init(&parser, &response_shape, &m);
+    int rc = perform_with(client, &client->allocator, "/api/metadata", "GET", 0, NULL, NULL, &parser, &status, &h);
+    if (rc != 0) {
+        nlx402_free_metadata(out);
+        return rc;
+    }
+    rc = json_read_finish(&parser, h, &client->allocator);
+    release_handle(client, h);
+    if (rc != 0) {
+        fprintf(stderr, "Failed to parse JSON from /api/metadata\n");
+        nlx402_free_metadata(out);
+        return -1;
+    }
+    return 0;
+}
+
+void nlx402_free_metadata(MetadataResponse *m) {
+    if (m) response_free(&metadata_schema, m);
+}
+
+
+void nlx402_free_auth_me(AuthMeResponse *r);
+
+int nlx402_get_auth_me(Nlx402Client *client, AuthMeResponse *out) {
+    long status;
+    Nlx402Handle *h = NULL;
+
+    ResponseParse r;
+    response_parse_init(&r, &auth_me_schema, client, out, &client->allocator);
+    JsonParser parser;
+    json_init(&parser, &response_shape, &r);
+    int rc = perform_with(client, &client->allocator, "/api/auth/me", "GET", 1, NULL, NULL, &parser, &status, &h);
+    if (rc != 0) {
+        nlx402_free_auth_me(out);
+        return rc;
+    }
+    rc = json_read_finish(&parser, h, &client->allocator);
+    release_handle(client, h);
+    if (rc != 0) {
+        fprintf(stderr, "Failed to parse JSON from /api/auth/me\n");
+        nlx402_free_auth_me(out);
+        return -1;
+    }
+    return 0;
+}
+
+void nlx402_free_auth_me(AuthMeResponse *r) {
+    if (r) response_free(&auth_me_schema, r);
+}
+
+
+void nlx402_free_quote(QuoteResponse *q);
+
+/* Fills the fields computed from the wire ones: exact units and decoded keys. */
+static void quote_derive(void *r) {
+    QuoteResponse *out = (QuoteResponse *)r;
+    out->amount_exact = out->amount && nlx402_amount_parse(out->amount, out->decimals, &out->amount_units) == 0;
+    if (nlx402_base58_decode(out->mint, strlen(out->mint), out->mint_key, sizeof(out->mint_key)) == 0)
+        out->keys_valid |= NLX402_KEY_MINT;
+    if (nlx402_base58_decode(out->recipient, strlen(out->recipient), out->recipient_key, sizeof(out->recipient_key)) == 0)
+        out->keys_valid |= NLX402_KEY_RECIPIENT;
+}
+
+static int get_quote_priced_with(
+    Nlx402Client *client,
+    const Nlx402Allocator *a,
+    const char *total_price,
+    QuoteResponse *out,
+    long *out_status
+) {
+    Nlx402Handle *h = NULL;
+
+    char header_buf[128];
+    snprintf(header_buf, sizeof(header_buf), "x-total-price: %s", total_price);
+
+    struct curl_slist extra;
+    extra.data = header_buf;
+    extra.next = NULL;
+
+    ResponseParse q;
+    response_parse_init(&q, &quote_schema, client, out, a);
+    JsonParser parser;
+    json_init(&parser, &response_shape, &q);
+    parser.keep_raw = 1;
+    int rc = perform_with(client, a, "/protected", "GET", 1, &extra, NULL, &parser, out_status, &h);
+    if (rc != 0) {
+        nlx402_free_quote(out);
+        return rc;
+    }
+    out->raw = (char *)mem_alloc(a, NLX402_MEM_RESPONSES, h->recv_size + 1);
+    if (!out->raw) {
+        release_handle(client, h);
+        nlx402_free_quote(out);
+        return -1;
+    }
+    memcpy(out->raw, h->recv, h->recv_size + 1);
+    out->raw_len = h->recv_size;
+    rc = json_read_kept(&parser, h, a, out->raw, out->raw_len);
+    release_handle(client, h);
+    if (rc != 0) {
+        fprintf(stderr, "Failed to parse JSON from /protected (quote)\n");
+        nlx402_free_quote(out);
+        return -1;
+    }
+
+    if (!q.fits) {
+        fprintf(stderr, "Oversized key or nonce in /protected (quote)\n");
+        nlx402_free_quote(out);
+        return -1;
+    }
+    quote_derive(out);
+    return 0;
+}
+
+static int get_quote_with(
+    Nlx402Client *client,
+    const Nlx402Allocator *a,
+    double total_price,
+    QuoteResponse *out,
+    long *out_status
+) {
+    if (total_price <= 0.0) total_price = 0.5;
+
+    char price[64];
+    if (num_format_price(total_price, price, sizeof(price)) == 0) return -1;
+    return get_quote_priced_with(client, a, price, out, out_status);
+}
+
+int nlx402_get_quote(Nlx402Client *client, double total_price, QuoteResponse *out) {
+    return get_quote_with(client, &client->allocator, total_price, out, NULL);
+}
+
+int nlx402_get_quote_units(Nlx402Client *client, unsigned long long units, int decimals, QuoteResponse *out) {
+    char price[NLX402_AMOUNT_MAX + 1];
+    if (units == 0 || nlx402_amount_format(units, decimals, price, sizeof(price)) == 0) {
+        fprintf(stderr, "Invalid quote price: %llu units at %d decimals\n", units, decimals);
+        return -1;
+    }
+    return get_quote_priced_with(client, &client->allocator, price, out, NULL);
+}
+
+void nlx402_free_quote(QuoteResponse *q) {
+    if (q) response_free(&quote_schema, q);
+}
+
+
+static int verify_quote_with(
+    Nlx402Client *client,
+    const Nlx402Allocator *a,
+    const QuoteResponse *quote,
+    const char *nonce,
+    VerifyResponse *out
+) {
+    if (!nonce || !quote || !quote->nonce[0]) {
+        fprintf(stderr, "verify_quote: nonce and quote are required\n");
+        return -1;
+    }
+
+    /* A quote that came from the server goes back byte for byte; one built
+     * by hand has no raw bytes and is written out from its fields. */
+    char *quote_str = NULL;
+    const char *quote_json = quote->raw;
+    size_t quote_len = quote->raw_len;
+    if (!quote_json) {
+        quote_len = response_write(&quote_schema, quote, NULL, 0);
+        quote_str = (char *)mem_alloc(a, NLX402_MEM_REQUESTS, quote_len + 1);
+        if (!quote_str) return -1;
+        response_write(&quote_schema, quote, quote_str, quote_len + 1);
+        quote_json = quote_str;
+    }
+
+    /* The form body is written once, encoding as it goes, into the handle's
+     * send buffer sized for the worst case. */
+    Nlx402Handle *h = acquire_handle(client);
+    size_t nonce_len = strlen(nonce);
+    char *body = h ? send_reserve(h, sizeof("payment_data=&nonce=") + 3 * (quote_len + nonce_len)) : NULL;
+    if (!body) {
+        release_handle(client, h);
+        mem_free(a, quote_str);
+        return -1;
+    }
+    char *w = body;
+    memcpy(w, "payment_data=", strlen("payment_data="));
+    w = url_encode(w + strlen("payment_data="), quote_json, quote_len);
+    memcpy(w, "&nonce=", strlen("&nonce="));
+    w = url_encode(w + strlen("&nonce="), nonce, nonce_len);
+    *w = '\0';
+    mem_free(a, quote_str);
+
+    struct curl_slist extra_headers;
+    extra_headers.data = "Content-Type: application/x-www-form-urlencoded";
+    extra_headers.next = NULL;
+
+    long status;
+    ResponseParse v;
+    response_parse_init(&v, &verify_schema, client, out, a);
+    JsonParser parser;
+    json_init(&parser, &response_shape, &v);
+    int rc = perform_with(client, a, "/verify", "POST", 1, &extra_headers, body, &parser, &status, &h);
+    if (rc != 0) return rc;
+
+    rc = json_read_finish(&parser, h, a);
+    release_handle(client, h);
+    if (rc != 0) {
+        fprintf(stderr, "Failed to parse JSON from /verify\n");
+        return -1;
+    }
+    return 0;
+}
+
+
+int nlx402_verify_quote(Nlx402Client *client, const QuoteResponse *quote, const char *nonce, VerifyResponse *out) {
+    return verify_quote_with(client, &client->allocator, quote, nonce, out);
+}
+
+
+void nlx402_free_paid_access(PaidAccessResponse *p);
+
+static void paid_access_derive(void *r) {
+    PaidAccessResponse *out = (PaidAccessResponse *)r;
+    out->amount_exact = out->amount && nlx402_amount_parse(out->amount, out->decimals, &out->amount_units) == 0;
+    if (nlx402_base58_decode(out->mint, strlen(out->mint), out->mint_key, sizeof(out->mint_key)) == 0)
+        out->keys_valid |= NLX402_KEY_MINT;
+    if (nlx402_base58_decode(out->tx, strlen(out->tx), out->tx_sig, sizeof(out->tx_sig)) == 0)
+        out->keys_valid |= NLX402_KEY_TX;
+}
+
+/* Writes the x-payment header into the handle's send buffer. Signatures and
+ * nonces never need escaping in practice, so they are normally copied
+ * straight through. */
+static char *payment_header(Nlx402Handle *h, const char *tx, const char *nonce) {
+    static const char head[] = "x-payment: {\"tx\":";
+    static const char mid[] = ",\"nonce\":";
+    size_t tx_len = strlen(tx);
+    size_t nonce_len = strlen(nonce);
+    int plain = json_plain_run(tx, tx_len) == tx_len && json_plain_run(nonce, nonce_len) == nonce_len;
+    size_t values = plain ? tx_len + nonce_len + 4 : json_string_size(tx) + json_string_size(nonce);
+
+    char *header = send_reserve(h, sizeof(head) + sizeof(mid) + values + 1);
+    if (!header) return NULL;
+    char *w = header;
+    memcpy(w, head, sizeof(head) - 1);
+    w += sizeof(head) - 1;
+    if (plain) {
+        *w++ = '"';
+        memcpy(w, tx, tx_len);
+        w += tx_len;
+        *w++ = '"';
+    } else {
+        w = json_put_string(w, tx);
+    }
+    memcpy(w, mid, sizeof(mid) - 1);
+    w += sizeof(mid) - 1;
+    if (plain) {
+        *w++ = '"';
+        memcpy(w, nonce, nonce_len);
+        w += nonce_len;
+        *w++ = '"';
+    } else {
+        w = json_put_string(w, nonce);
+    }
+    *w++ = '}';
+    *w = '\0';
+    return header;
+}
+
+static int get_paid_access_with(
+    Nlx402Client *client,
+    const Nlx402Allocator *a,
+    const char *tx,
+    const char *nonce,
+    PaidAccessResponse *out,
+    long *out_status
+) {
+    if (!tx || !nonce) {
+        fprintf(stderr, "get_paid_access: tx and nonce are required\n");
+        return -1;
+    }
+
+    Nlx402Handle *h = acquire_handle(client);
+    char *header_buf = h ? payment_header(h, tx, nonce) : NULL;
+    if (!header_buf) {
+        release_handle(client, h);
+        return -1;
+    }
+
+    struct curl_slist extra_headers;
+    extra_headers.data = header_buf;
+    extra_headers.next = NULL;
+
+    ResponseParse pa;
+    response_parse_init(&pa, &paid_access_schema, client, out, a);
+    JsonParser parser;
+    json_init(&parser, &response_shape, &pa);
+    int rc = perform_with(client, a, "/protected", "GET", 1, &extra_headers, NULL, &parser, out_status, &h);
+
+    if (rc != 0) {
+        nlx402_free_paid_access(out);
+        return rc;
+    }
+
+    rc = json_read_finish(&parser, h, a);
+    release_handle(client, h);
+    if (rc != 0) {
+        fprintf(stderr, "Failed to parse JSON from /protected (paid)\n");
+        nlx402_free_paid_access(out);
+        return -1;
+    }
+
+    if (!pa.fits) {
+        fprintf(stderr, "Oversized key or signature in /protected (paid)\n");
+        nlx402_free_paid_access(out);
+        return -1;
+    }
+    paid_access_derive(out);
+    return 0;
+}
+
+int nlx402_get_paid_access(Nlx402Client *client, const char *tx, const char *nonce, PaidAccessResponse *out) {
+    return get_paid_access_with(client, &client->allocator, tx, nonce, out, NULL);
+}
+
+void nlx402_free_paid_access(PaidAccessResponse *p) {
+    if (p) response_free(&paid_access_schema, p);
+}
+
+/* Flat responses are a self-contained little-endian image of a response
+ * for other processes and shared caches, read in place without parsing:
+ *
+ *   0   "NLXB", u16 version, u16 type, u32 total size, u16 field count, u16 0
+ *   16  one 8-byte slot per schema field, in table order
+ *       bool/int: i64; number: IEEE double; string, list, raw body: u32
+ *       offset of its record (0 when missing); nested object: 0
+ *   ... records, 4-byte aligned: a string is u32 length, bytes and a NUL;
+ *       a list is u32 count and a u32 string record offset per item
+ *
+ * A later version may only append fields, with their slots after these and
+ * their records anywhere, so readers accept any version from 1 on with at
+ * least the fields they know, and skip the rest. */
+#define FLAT_HEADER 16
+#define FLAT_SLOT 8
+
+static const ResponseSchema *const flat_schemas[] = {
+    NULL, &metadata_schema, &quote_schema, &paid_access_schema,
+};
+
+static void flat_put_u16(unsigned char *b, unsigned int v) {
+    b[0] = (unsigned char)v;
+    b[1] = (unsigned char)(v >> 8);
+}
+
+static void flat_put_u32(unsigned char *b, unsigned long v) {
+    for (int i = 0; i < 4; i++) b[i] = (unsigned char)(v >> (8 * i));
+}
+
+static void flat_put_u64(unsigned char *b, unsigned long long v) {
+    for (int i = 0; i < 8; i++) b[i] = (unsigned char)(v >> (8 * i));
+}
+
+static unsigned long flat_u32(const unsigned char *b) {
+    return (unsigned long)b[0] | (unsigned long)b[1] << 8 | (unsigned long)b[2] << 16 | (unsigned long)b[3] << 24;
+}
+
+static unsigned long long flat_u64(const unsigned char *b) {
+    unsigned long long v = 0;
+    for (int i = 7; i >= 0; i--) v = v << 8 | b[i];
+    return v;
+}
+
+static size_t flat_string_size(size_t n) {
+    return (4 + n + 1 + 3) & ~(size_t)3;
+}
+
+static size_t flat_put_string(unsigned char *buf, size_t at, const char *s, size_t n) {
+    size_t size = flat_string_size(n);
+    flat_put_u32(buf + at, (unsigned long)n);
+    memcpy(buf + at + 4, s, n);
+    memset(buf + at + 4 + n, 0, size - 4 - n);
+    return at + size;
+}
+
+/* The bytes of a string-valued member, or NULL when it is missing. */
+static const char *flat_field_string(const ResponseField *f, const char *r, size_t *n) {
+    const char *s = f->kind == F_INLINE ? r + f->offset : *(const char *const *)(r + f->offset);
+    if (!s) return NULL;
+    *n = f->kind == F_BLOB ? *(const size_t *)(r + f->count) : strlen(s);
+    return s;
+}
+
+/* Writes r into buf; returns the size, or 0 if it does not fit in cap. With
+ * buf NULL it only returns the size. */
+static size_t flat_write(const ResponseSchema *sc, int type, const void *resp, void *out, size_t cap) {
+    const char *r = (const char *)resp;
+    unsigned char *buf = (unsigned char *)out;
+    size_t size = FLAT_HEADER + FLAT_SLOT * (size_t)sc->count;
+    for (int i = 0; i < sc->count; i++) {
+        const ResponseField *f = &sc->fields[i];
+        size_t n;
+        if (f->kind == F_LIST) {
+            const char *const *items = *(const char *const *const *)(r + f->offset);
+            int count = *(const int *)(r + f->count);
+            size += 4 + 4 * (size_t)count;
+            for (int k = 0; k < count; k++) {
+                if (items[k]) size += flat_string_size(strlen(items[k]));
+            }
+        } else if (f->kind != F_BOOL && f->kind != F_INT && f->kind != F_NUMBER && f->kind != F_OBJECT &&
+                   flat_field_string(f, r, &n)) {
+            size += flat_string_size(n);
+        }
     }
+    if (!buf) return size;
+    if (size > cap || size > 0xffffffffUL) return 0;
 
-    cJSON *p = cJSON_CreateObject();
-    cJSON_AddStringToObject(p, "tx", tx);
-    cJSON_AddStringToObject(p, "nonce", nonce);
-    char *payment_str = cJSON_PrintUnformatted(p);
-    cJSON_Delete(p);
-    if (!payment_str) return -1;
+    memset(buf, 0, FLAT_HEADER + FLAT_SLOT * (size_t)sc->count);
+    memcpy(buf, "NLXB", 4);
+    flat_put_u16(buf + 4, NLX402_FLAT_VERSION);
+    flat_put_u16(buf + 6, (unsigned int)type);
+    flat_put_u32(buf + 8, (unsigned long)size);
+    flat_put_u16(buf + 12, (unsigned int)sc->count);
 
-    size_t header_len = strlen("x-payment: ") + strlen(payment_str) + 1;
-    char *header_buf = (char *)malloc(header_len);
-    if (!header_buf) {
-        free(payment_str);
+    size_t at = FLAT_HEADER + FLAT_SLOT * (size_t)sc->count;
+    for (int i = 0; i < sc->count; i++) {
+        const ResponseField *f = &sc->fields[i];
+        unsigned char *slot = buf + FLAT_HEADER + FLAT_SLOT * (size_t)i;
+        const char *field = r + f->offset;
+        size_t n;
+        switch (f->kind) {
+        case F_BOOL:
+        case F_INT:
+            flat_put_u64(slot, (unsigned long long)(long long)*(const int *)field);
+            break;
+        case F_NUMBER: {
+            unsigned long long bits;
+            memcpy(&bits, field, sizeof(bits));
+            flat_put_u64(slot, bits);
+            break;
+        }
+        case F_LIST: {
+            const char *const *items = *(const char *const *const *)field;
+            int count = *(const int *)(r + f->count);
+            size_t list = at;
+            flat_put_u32(slot, (unsigned long)list);
+            flat_put_u32(buf + list, (unsigned long)count);
+            at += 4 + 4 * (size_t)count;
+            for (int k = 0; k < count; k++) {
+                flat_put_u32(buf + list + 4 + 4 * (size_t)k, items[k] ? (unsigned long)at : 0);
+                if (items[k]) at = flat_put_string(buf, at, items[k], strlen(items[k]));
+            }
+            break;
+        }
+        case F_OBJECT:
+            break;
+        default: {
+            const char *s = flat_field_string(f, r, &n);
+            if (!s) break;
+            flat_put_u32(slot, (unsigned long)at);
+            at = flat_put_string(buf, at, s, n);
+        }
+        }
+    }
+    return size;
+}
+
+/* The schema of a well-formed flat buffer and its size, or NULL. */
+static const ResponseSchema *flat_schema(const unsigned char *b, size_t len, int *type, size_t *size) {
+    if (!b || len < FLAT_HEADER || memcmp(b, "NLXB", 4) != 0) return NULL;
+    unsigned int version = b[4] | (unsigned int)b[5] << 8;
+    unsigned int t = b[6] | (unsigned int)b[7] << 8;
+    unsigned int count = b[12] | (unsigned int)b[13] << 8;
+    *size = flat_u32(b + 8);
+    if (version < 1 || t == 0 || t >= sizeof(flat_schemas) / sizeof(flat_schemas[0])) return NULL;
+    const ResponseSchema *sc = flat_schemas[t];
+    if (*size > len || count < (unsigned int)sc->count || FLAT_HEADER + FLAT_SLOT * (size_t)count > *size) return NULL;
+    *type = (int)t;
+    return sc;
+}
+
+/* A string record at off, checked against the buffer. */
+static int flat_record(const unsigned char *b, size_t size, size_t off, Nlx402View *out) {
+    if (off < FLAT_HEADER || off > size || size - off < 5) return -1;
+    size_t n = flat_u32(b + off);
+    if (n > size - off - 5 || b[off + 4 + n] != '\0') return -1;
+    out->ptr = (const char *)b + off + 4;
+    out->len = n;
+    return 0;
+}
+
+/* Item count of a list record at off, checked against the buffer. */
+static int flat_list(const unsigned char *b, size_t size, size_t off) {
+    if (off == 0) return 0;
+    if (off < FLAT_HEADER || off > size || size - off < 4) return -1;
+    size_t count = flat_u32(b + off);
+    return count <= (size - off - 4) / 4 ? (int)count : -1;
+}
+
+/* Resolves a dotted path to a field and its slot. */
+static const unsigned char *flat_find(const void *buf, size_t len, const char *path, const ResponseField **field,
+                                      size_t *size) {
+    int type;
+    const unsigned char *b = (const unsigned char *)buf;
+    const ResponseSchema *sc = flat_schema(b, len, &type, size);
+    if (!sc || !path) return NULL;
+    int parent = JSON_ROOT;
+    const ResponseField *f = NULL;
+    while (*path) {
+        const char *dot = strchr(path, '.');
+        size_t n = dot ? (size_t)(dot - path) : strlen(path);
+        f = NULL;
+        for (int i = 0; i < sc->count; i++) {
+            const ResponseField *c = &sc->fields[i];
+            int c_parent = c->parent == JSON_SKIP ? JSON_ROOT : c->parent;
+            if (c_parent == parent && c->len == n && memcmp(c->name, path, n) == 0) {
+                f = c;
+                break;
+            }
+        }
+        if (!f) return NULL;
+        parent = f->slot;
+        path += dot ? n + 1 : n;
+    }
+    if (!f) return NULL;
+    *field = f;
+    return b + FLAT_HEADER + FLAT_SLOT * (size_t)(f->slot - JSON_ROOT - 1);
+}
+
+/* Type of a flat buffer (NLX402_FLAT_*), or -1 if it is not one. */
+int nlx402_flat_type(const void *buf, size_t len) {
+    int type;
+    size_t size;
+    return flat_schema((const unsigned char *)buf, len, &type, &size) ? type : -1;
+}
+
+int nlx402_flat_string(const void *buf, size_t len, const char *path, Nlx402View *out) {
+    const ResponseField *f;
+    size_t size;
+    const unsigned char *slot = flat_find(buf, len, path, &f, &size);
+    if (!slot || f->kind == F_BOOL || f->kind == F_INT || f->kind == F_NUMBER || f->kind == F_LIST || f->kind == F_OBJECT)
+        return -1;
+    Nlx402View v;
+    if (flat_record((const unsigned char *)buf, size, flat_u32(slot), &v) != 0) return -1;
+    if (out) *out = v;
+    return 0;
+}
+
+int nlx402_flat_bool(const void *buf, size_t len, const char *path, int *out) {
+    const ResponseField *f;
+    size_t size;
+    const unsigned char *slot = flat_find(buf, len, path, &f, &size);
+    if (!slot || f->kind != F_BOOL) return -1;
+    if (out) *out = flat_u64(slot) != 0;
+    return 0;
+}
+
+int nlx402_flat_number(const void *buf, size_t len, const char *path, double *out) {
+    const ResponseField *f;
+    size_t size;
+    const unsigned char *slot = flat_find(buf, len, path, &f, &size);
+    if (!slot || (f->kind != F_INT && f->kind != F_NUMBER)) return -1;
+    unsigned long long bits = flat_u64(slot);
+    double v;
+    if (f->kind == F_INT) v = (double)(long long)bits;
+    else memcpy(&v, &bits, sizeof(v));
+    if (out) *out = v;
+    return 0;
+}
+
+/* Number of items in the list at path, or -1. */
+int nlx402_flat_count(const void *buf, size_t len, const char *path) {
+    const ResponseField *f;
+    size_t size;
+    const unsigned char *slot = flat_find(buf, len, path, &f, &size);
+    if (!slot || f->kind != F_LIST) return -1;
+    return flat_list((const unsigned char *)buf, size, flat_u32(slot));
+}
+
+int nlx402_flat_string_at(const void *buf, size_t len, const char *path, int index, Nlx402View *out) {
+    const ResponseField *f;
+    size_t size;
+    const unsigned char *slot = flat_find(buf, len, path, &f, &size);
+    const unsigned char *b = (const unsigned char *)buf;
+    if (!slot || f->kind != F_LIST || index < 0 || index >= flat_list(b, size, flat_u32(slot))) return -1;
+    Nlx402View v;
+    if (flat_record(b, size, flat_u32(b + flat_u32(slot) + 4 + 4 * (size_t)index), &v) != 0) return -1;
+    if (out) *out = v;
+    return 0;
+}
+
+/* Rebuilds a response from a flat buffer. Strings go through the same
+ * handler as parsed ones, so they are interned, copied and size-checked
+ * exactly as if they had come from the server. */
+static int flat_read(const ResponseSchema *sc, int type, void (*derive)(void *), Nlx402Client *client,
+                     const void *buf, size_t len, void *out) {
+    const unsigned char *b = (const unsigned char *)buf;
+    ResponseParse r;
+    response_parse_init(&r, sc, client, out, &client->allocator);
+    int buf_type;
+    size_t size;
+    if (flat_schema(b, len, &buf_type, &size) != sc || buf_type != type) return -1;
+
+    for (int i = 0; i < sc->count; i++) {
+        const ResponseField *f = &sc->fields[i];
+        const unsigned char *slot = b + FLAT_HEADER + FLAT_SLOT * (size_t)i;
+        char *field = (char *)out + f->offset;
+        Nlx402View v;
+        int rc = 0;
+        switch (f->kind) {
+        case F_BOOL:
+        case F_INT:
+            *(int *)field = (int)(long long)flat_u64(slot);
+            break;
+        case F_NUMBER: {
+            unsigned long long bits = flat_u64(slot);
+            memcpy(field, &bits, sizeof(bits));
+            break;
+        }
+        case F_LIST: {
+            int count = flat_list(b, size, flat_u32(slot));
+            if (count < 0) rc = -1;
+            else rc = response_value(&r, f->slot, -1, JSON_ARRAY, NULL, 0);
+            for (int k = 0; rc == 0 && k < count; k++) {
+                const unsigned char *item = b + flat_u32(slot) + 4 + 4 * (size_t)k;
+                if (flat_u32(item) == 0) {
+                    rc = response_value(&r, f->slot, k, JSON_NULL, NULL, 0);
+                } else {
+                    rc = flat_record(b, size, flat_u32(item), &v);
+                    if (rc == 0) rc = response_value(&r, f->slot, k, JSON_STRING, v.ptr, v.len);
+                }
+            }
+            break;
+        }
+        case F_OBJECT:
+            break;
+        case F_BLOB:
+            if (flat_u32(slot) == 0) break;
+            rc = flat_record(b, size, flat_u32(slot), &v);
+            if (rc == 0) {
+                char *copy = (char *)mem_alloc(r.allocator, NLX402_MEM_RESPONSES, v.len + 1);
+                if (!copy) {
+                    rc = -1;
+                    break;
+                }
+                memcpy(copy, v.ptr, v.len + 1);
+                *(char **)field = copy;
+                *(size_t *)((char *)out + f->count) = v.len;
+            }
+            break;
+        default:
+            if (flat_u32(slot) == 0) break;
+            rc = flat_record(b, size, flat_u32(slot), &v);
+            if (rc == 0) rc = response_value(&r, f->slot, -1, JSON_STRING, v.ptr, v.len);
+        }
+        if (rc != 0) {
+            response_free(sc, out);
+            return -1;
+        }
+    }
+    if (!r.fits) {
+        response_free(sc, out);
         return -1;
     }
-    snprintf(header_buf, header_len, "x-payment: %s", payment_str);
+    if (derive) derive(out);
+    return 0;
+}
 
-    struct curl_slist extra_headers;
-    extra_headers.data = header_buf;
-    extra_headers.next = NULL;
+#define FLAT_API(name, Type, schema, type, derive) \
+    size_t nlx402_flat_write_##name(const Type *r, void *buf, size_t cap) { \
+        return flat_write(&schema, type, r, buf, cap); \
+    } \
+    int nlx402_flat_read_##name(Nlx402Client *client, const void *buf, size_t len, Type *out) { \
+        return flat_read(&schema, type, derive, client, buf, len, out); \
+    }
 
-    long status;
-    MemoryChunk chunk = {0};
-    int rc = nlx402_request(client, "/protected", "GET", 1, &extra_headers, NULL, &status, &chunk);
+FLAT_API(metadata, MetadataResponse, metadata_schema, NLX402_FLAT_METADATA, NULL)
+FLAT_API(quote, QuoteResponse, quote_schema, NLX402_FLAT_QUOTE, quote_derive)
+FLAT_API(paid_access, PaidAccessResponse, paid_access_schema, NLX402_FLAT_PAID_ACCESS, paid_access_derive)
+
+/* Lazy responses keep the body and index where every value starts and ends,
+ * in document order, so a parent always precedes its children. Nothing is
+ * decoded until asked for: strings with escapes are unescaped in place in
+ * the body on first access, which is why the accessors take a mutable
+ * response. */
+static int lazy_add(Nlx402LazyResponse *r, int parent, unsigned int key_off, unsigned int key_len, int type, size_t val_off) {
+    if (r->count == r->cap) {
+        int grown = r->cap ? r->cap * 2 : 16;
+        Nlx402LazyEntry *entries = (Nlx402LazyEntry *)mem_realloc(r->allocator, NLX402_MEM_RESPONSES, r->entries,
+                                                                  (size_t)grown * sizeof(*entries));
+        if (!entries) return -1;
+        r->entries = entries;
+        r->cap = grown;
+    }
+    Nlx402LazyEntry *e = &r->entries[r->count];
+    memset(e, 0, sizeof(*e));
+    e->parent = parent;
+    e->key_off = key_off;
+    e->key_len = key_len;
+    e->type = (unsigned char)type;
+    e->val_off = (unsigned int)val_off;
+    if (parent >= 0) r->entries[parent].count++;
+    return r->count++;
+}
+
+/* Finds the closing quote of the string opening at s[i]; sets *escaped if it
+ * contains a backslash. */
+static size_t lazy_string_end(const char *s, size_t n, size_t i, unsigned char *escaped) {
+    for (i++; i < n; i++) {
+        if (s[i] == '"') return i;
+        if ((unsigned char)s[i] < 0x20) return n;
+        if (s[i] == '\\') {
+            *escaped = 1;
+            i++;
+        }
+    }
+    return n;
+}
+
+static int lazy_index(Nlx402LazyResponse *r) {
+    const char *s = r->body;
+    size_t n = r->len;
+    int stack[JSON_DEPTH_MAX];
+    int depth = 0;
+    int state = JS_VALUE;
+    unsigned int key_off = 0;
+    unsigned int key_len = 0;
+
+    if (n > 0xffffffffu) return -1;
+    for (size_t i = 0; i < n; i++) {
+        char c = s[i];
+        if (json_is_space(c)) continue;
+        switch (state) {
+        case JS_ARRAY_FIRST:
+        case JS_VALUE: {
+            if (state == JS_ARRAY_FIRST && c == ']') goto close;
+            int parent = depth ? stack[depth - 1] : -1;
+            if (parent >= 0 && r->entries[parent].type == JSON_ARRAY) key_off = key_len = 0;
+            int e;
+            if (c == '{' || c == '[') {
+                if (depth == JSON_DEPTH_MAX) return -1;
+                e = lazy_add(r, parent, key_off, key_len, c == '{' ? JSON_OBJECT : JSON_ARRAY, i);
+                if (e < 0) return -1;
+                stack[depth++] = e;
+                state = c == '{' ? JS_OBJECT_FIRST : JS_ARRAY_FIRST;
+                continue;
+            }
+            size_t end;
+            int type;
+            unsigned char escaped = 0;
+            if (c == '"') {
+                end = lazy_string_end(s, n, i, &escaped);
+                if (end == n) return -1;
+                i++;
+                type = JSON_STRING;
+            } else if (c == 't' || c == 'f' || c == 'n') {
+                const char *lit = c == 't' ? "true" : c == 'f' ? "false" : "null";
+                size_t len = strlen(lit);
+                if (n - i < len || memcmp(s + i, lit, len) != 0) return -1;
+                end = i + len;
+                type = c == 't' ? JSON_TRUE : c == 'f' ? JSON_FALSE : JSON_NULL;
+            } else if (c == '-' || (c >= '0' && c <= '9')) {
+                end = i + 1;
+                while (end < n && ((s[end] >= '0' && s[end] <= '9') || s[end] == '.' || s[end] == 'e' ||
+                                   s[end] == 'E' || s[end] == '+' || s[end] == '-')) end++;
+                type = JSON_NUMBER;
+            } else {
+                return -1;
+            }
+            e = lazy_add(r, parent, key_off, key_len, type, i);
+            if (e < 0) return -1;
+            r->entries[e].val_len = (unsigned int)(end - i);
+            r->entries[e].escaped = escaped;
+            i = type == JSON_STRING ? end : end - 1;
+            state = depth ? JS_AFTER_VALUE : JS_DONE;
+            continue;
+        }
+        case JS_OBJECT_FIRST:
+            if (c == '}') goto close;
+            /* fall through */
+        case JS_KEY: {
+            unsigned char escaped = 0;
+            if (c != '"') return -1;
+            size_t end = lazy_string_end(s, n, i, &escaped);
+            if (end == n) return -1;
+            key_off = (unsigned int)(i + 1);
+            key_len = (unsigned int)(end - i - 1);
+            i = end;
+            state = JS_COLON;
+            continue;
+        }
+        case JS_COLON:
+            if (c != ':') return -1;
+            state = JS_VALUE;
+            continue;
+        case JS_AFTER_VALUE:
+            if (c == ',') {
+                state = r->entries[stack[depth - 1]].type == JSON_ARRAY ? JS_VALUE : JS_KEY;
+                continue;
+            }
+            if (c == '}' || c == ']') goto close;
+            return -1;
+        default:
+            return -1;
+        }
+close:
+        if (depth == 0 || (r->entries[stack[depth - 1]].type == JSON_ARRAY) != (c == ']')) return -1;
+        depth--;
+        r->entries[stack[depth]].val_len = (unsigned int)(i + 1 - r->entries[stack[depth]].val_off);
+        state = depth ? JS_AFTER_VALUE : JS_DONE;
+    }
+    return state == JS_DONE ? 0 : -1;
+}
+
+static Nlx402LazyEntry *lazy_find(Nlx402LazyResponse *r, const char *path) {
+    if (!r || !path || r->count == 0) return NULL;
+    int cur = 0;
+    while (*path) {
+        const char *dot = strchr(path, '.');
+        size_t len = dot ? (size_t)(dot - path) : strlen(path);
+        int next = -1;
+        for (int i = cur + 1; i < r->count; i++) {
+            const Nlx402LazyEntry *e = &r->entries[i];
+            if (e->parent == cur && e->key_len == len && strncasecmp(r->body + e->key_off, path, len) == 0) {
+                next = i;
+                break;
+            }
+        }
+        if (next < 0) return NULL;
+        cur = next;
+        path += dot ? len + 1 : len;
+    }
+    return &r->entries[cur];
+}
+
+static size_t lazy_unescape(char *s, size_t len) {
+    size_t out = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] != '\\') {
+            s[out++] = s[i];
+            continue;
+        }
+        if (++i == len) return (size_t)-1;
+        switch (s[i]) {
+        case '"': case '\\': case '/': s[out++] = s[i]; break;
+        case 'b': s[out++] = '\b'; break;
+        case 'f': s[out++] = '\f'; break;
+        case 'n': s[out++] = '\n'; break;
+        case 'r': s[out++] = '\r'; break;
+        case 't': s[out++] = '\t'; break;
+        case 'u': {
+            unsigned int cp = 0;
+            for (int pair = 0; ; pair++) {
+                unsigned int unit = 0;
+                if (len - i < 5) return (size_t)-1;
+                for (int k = 1; k <= 4; k++) {
+                    int v = hex_value(s[i + k]);
+                    if (v < 0) return (size_t)-1;
+                    unit = (unit << 4) | (unsigned int)v;
+                }
+                i += 4;
+                if (pair == 0 && unit >= 0xd800 && unit <= 0xdbff) {
+                    if (len - i < 3 || s[i + 1] != '\\' || s[i + 2] != 'u') return (size_t)-1;
+                    cp = unit;
+                    i += 2;
+                    continue;
+                }
+                if (pair == 0 && unit >= 0xdc00 && unit <= 0xdfff) return (size_t)-1;
+                if (pair == 1) {
+                    if (unit < 0xdc00 || unit > 0xdfff) return (size_t)-1;
+                    unit = 0x10000 + ((cp - 0xd800) << 10) + (unit - 0xdc00);
+                }
+                cp = unit;
+                break;
+            }
+            out += utf8_encode(cp, s + out);
+            break;
+        }
+        default:
+            return (size_t)-1;
+        }
+    }
+    return out;
+}
+
+static int lazy_view(Nlx402LazyResponse *r, Nlx402LazyEntry *e, Nlx402View *out) {
+    if (!e || e->type != JSON_STRING) return -1;
+    if (e->escaped) {
+        size_t len = lazy_unescape(r->body + e->val_off, e->val_len);
+        if (len == (size_t)-1) return -1;
+        e->val_len = (unsigned int)len;
+        e->escaped = 0;
+    }
+    if (out) {
+        out->ptr = r->body + e->val_off;
+        out->len = e->val_len;
+    }
+    return 0;
+}
+
+/* Paths name members from the top-level object, separated by dots:
+ * "ok", "x402.status", "metadata.supported_chains". */
+int nlx402_lazy_string(Nlx402LazyResponse *r, const char *path, Nlx402View *out) {
+    return lazy_view(r, lazy_find(r, path), out);
+}
+
+int nlx402_lazy_bool(Nlx402LazyResponse *r, const char *path, int *out) {
+    Nlx402LazyEntry *e = lazy_find(r, path);
+    if (!e || (e->type != JSON_TRUE && e->type != JSON_FALSE)) return -1;
+    if (out) *out = e->type == JSON_TRUE;
+    return 0;
+}
+
+int nlx402_lazy_number(Nlx402LazyResponse *r, const char *path, double *out) {
+    Nlx402LazyEntry *e = lazy_find(r, path);
+    if (!e || e->type != JSON_NUMBER) return -1;
+    double v;
+    if (json_number(r->body + e->val_off, e->val_len, &v) != 0) return -1;
+    if (out) *out = v;
+    return 0;
+}
+
+/* Number of members or elements of the object or array at path, or -1. */
+int nlx402_lazy_count(Nlx402LazyResponse *r, const char *path) {
+    Nlx402LazyEntry *e = lazy_find(r, path);
+    if (!e || (e->type != JSON_OBJECT && e->type != JSON_ARRAY)) return -1;
+    return e->count;
+}
+
+int nlx402_lazy_string_at(Nlx402LazyResponse *r, const char *path, int index, Nlx402View *out) {
+    Nlx402LazyEntry *e = lazy_find(r, path);
+    if (!e || e->type != JSON_ARRAY || index < 0 || index >= e->count) return -1;
+    int parent = (int)(e - r->entries);
+    for (int i = parent + 1; i < r->count; i++) {
+        if (r->entries[i].parent == parent && index-- == 0) return lazy_view(r, &r->entries[i], out);
+    }
+    return -1;
+}
 
-    free(payment_str);
-    free(header_buf);
+void nlx402_free_lazy(Nlx402LazyResponse *r) {
+    if (!r) return;
+    const Nlx402Allocator *a = allocator_or_default(r->allocator);
+    if (r->entries) mem_free(a, r->entries);
+    if (r->body) mem_free(a, r->body);
+    memset(r, 0, sizeof(*r));
+}
+
+static int get_lazy(
+    Nlx402Client *client,
+    const char *path,
+    int require_api_key,
+    struct curl_slist *extra_headers,
+    Nlx402Handle *h,
+    Nlx402LazyResponse *out
+) {
+    long status;
+    memset(out, 0, sizeof(*out));
+    out->allocator = &client->allocator;
 
+    int rc = perform_with(client, &client->allocator, path, "GET", require_api_key, extra_headers, NULL, NULL, &status, &h);
     if (rc != 0) return rc;
 
-    cJSON *root = cJSON_Parse(chunk.data);
-    if (!root) {
-        fprintf(stderr, "Failed to parse JSON from /protected (paid)\n");
-        free(chunk.data);
+    out->len = h->recv_size;
+    out->body = (char *)mem_alloc(&client->allocator, NLX402_MEM_RESPONSES, h->recv_size + 1);
+    if (out->body) memcpy(out->body, h->recv, h->recv_size + 1);
+    release_handle(client, h);
+    if (!out->body || lazy_index(out) != 0) {
+        fprintf(stderr, "Failed to parse JSON from %s\n", path);
+        nlx402_free_lazy(out);
         return -1;
     }
+    return 0;
+}
 
-    memset(out, 0, sizeof(*out));
-    out->ok = cJSON_IsTrue(cJSON_GetObjectItem(root, "ok"));
-
-    cJSON *x402 = cJSON_GetObjectItem(root, "x402");
-    if (x402 && cJSON_IsObject(x402)) {
-        cJSON *amount = cJSON_GetObjectItem(x402, "amount");
-        cJSON *decimals = cJSON_GetObjectItem(x402, "decimals");
-        cJSON *mint = cJSON_GetObjectItem(x402, "mint");
-        cJSON *nonce_j = cJSON_GetObjectItem(x402, "nonce");
-        cJSON *status_j = cJSON_GetObjectItem(x402, "status");
-        cJSON *tx_j = cJSON_GetObjectItem(x402, "tx");
-        cJSON *version = cJSON_GetObjectItem(x402, "version");
-
-        if (cJSON_IsString(amount)) out->amount = dup_string(amount->valuestring);
-        if (cJSON_IsNumber(decimals)) out->decimals = decimals->valueint;
-        if (cJSON_IsString(mint)) out->mint = dup_string(mint->valuestring);
-        if (cJSON_IsString(nonce_j)) out->nonce = dup_string(nonce_j->valuestring);
-        if (cJSON_IsString(status_j)) out->status = dup_string(status_j->valuestring);
-        if (cJSON_IsString(tx_j)) out->tx = dup_string(tx_j->valuestring);
-        if (cJSON_IsString(version)) out->version = dup_string(version->valuestring);
+int nlx402_get_metadata_lazy(Nlx402Client *client, Nlx402LazyResponse *out) {
+    return get_lazy(client, "/api/metadata", 0, NULL, NULL, out);
+}
+
+int nlx402_get_paid_access_lazy(Nlx402Client *client, const char *tx, const char *nonce, Nlx402LazyResponse *out) {
+    if (!tx || !nonce) {
+        fprintf(stderr, "get_paid_access: tx and nonce are required\n");
+        return -1;
+    }
+    Nlx402Handle *h = acquire_handle(client);
+    char *header_buf = h ? payment_header(h, tx, nonce) : NULL;
+    if (!header_buf) {
+        release_handle(client, h);
+        return -1;
     }
 
-    cJSON_Delete(root);
-    free(chunk.data);
-    return 0;
+    struct curl_slist extra_headers;
+    extra_headers.data = header_buf;
+    extra_headers.next = NULL;
+
+    return get_lazy(client, "/protected", 1, &extra_headers, h, out);
 }
 
-void nlx402_free_paid_access(PaidAccessResponse *p) {
-    if (!p) return;
-    if (p->amount) free(p->amount);
-    if (p->mint) free(p->mint);
-    if (p->nonce) free(p->nonce);
-    if (p->status) free(p->status);
-    if (p->tx) free(p->tx);
-    if (p->version) free(p->version);
+static int get_and_verify_quote_with(
+    Nlx402Client *client,
+    const Nlx402Allocator *a,
+    double total_price,
+    QuoteResponse *out_quote,
+    VerifyResponse *out_verify
+) {
+    int rc = get_quote_with(client, a, total_price, out_quote, NULL);
+    if (rc != 0) return rc;
+
+    rc = verify_quote_with(client, a, out_quote, out_quote->nonce, out_verify);
+    return rc;
 }
 
 int nlx402_get_and_verify_quote(
@@ -535,10 +4465,311 @@ int nlx402_get_and_verify_quote(
     QuoteResponse *out_quote,
     VerifyResponse *out_verify
 ) {
-    int rc = nlx402_get_quote(client, total_price, out_quote);
-    if (rc != 0) return rc;
+    return get_and_verify_quote_with(client, &client->allocator, total_price, out_quote, out_verify);
+}
+
+
+int nlx402_flow_begin(Nlx402Flow *flow, Nlx402Client *client, size_t block_size) {
+    if (!flow || !client) return -1;
+    flow->client = client;
+    arena_init(&flow->arena, &client->allocator, block_size);
+    return 0;
+}
+
+void nlx402_flow_reset(Nlx402Flow *flow) {
+    if (flow) arena_reset(&flow->arena);
+}
+
+void nlx402_flow_end(Nlx402Flow *flow) {
+    if (flow) arena_release(&flow->arena);
+}
+
+int nlx402_flow_get_quote(Nlx402Flow *flow, double total_price, QuoteResponse *out) {
+    return get_quote_with(flow->client, &flow->arena.allocator, total_price, out, NULL);
+}
+
+int nlx402_flow_verify_quote(Nlx402Flow *flow, const QuoteResponse *quote, const char *nonce, VerifyResponse *out) {
+    return verify_quote_with(flow->client, &flow->arena.allocator, quote, nonce, out);
+}
+
+int nlx402_flow_get_paid_access(Nlx402Flow *flow, const char *tx, const char *nonce, PaidAccessResponse *out) {
+    return get_paid_access_with(flow->client, &flow->arena.allocator, tx, nonce, out, NULL);
+}
+
+int nlx402_flow_get_and_verify_quote(
+    Nlx402Flow *flow,
+    double total_price,
+    QuoteResponse *out_quote,
+    VerifyResponse *out_verify
+) {
+    return get_and_verify_quote_with(flow->client, &flow->arena.allocator, total_price, out_quote, out_verify);
+}
+
+
+/* A call that outgrew the caller's buffer stopped at the allocation that
+ * did not fit, so out_needed is at least what it takes to get past it. A
+ * failed call's response points into the buffer or at the arena on the
+ * stack, so it is emptied whatever the cause. */
+static int finish_into(Nlx402Arena *arena, int rc, void *out, size_t out_size, size_t *out_needed) {
+    if (out_needed) *out_needed = arena_fixed_needed(arena);
+    if (arena->overflow > 0) rc = NLX402_ERR_BUFFER_TOO_SMALL;
+    if (rc != 0) memset(out, 0, out_size);
+    arena_release(arena);
+    return rc;
+}
+
+int nlx402_get_quote_into(
+    Nlx402Client *client,
+    double total_price,
+    QuoteResponse *out,
+    void *buf,
+    size_t cap,
+    size_t *out_needed
+) {
+    Nlx402Arena arena;
+    arena_init_fixed(&arena, buf, cap);
+    int rc = get_quote_with(client, &arena.allocator, total_price, out, NULL);
+    rc = finish_into(&arena, rc, out, sizeof(*out), out_needed);
+    if (rc == 0) out->allocator = &borrowed_allocator;
+    return rc;
+}
+
+int nlx402_verify_quote_into(
+    Nlx402Client *client,
+    const QuoteResponse *quote,
+    const char *nonce,
+    VerifyResponse *out,
+    void *buf,
+    size_t cap,
+    size_t *out_needed
+) {
+    Nlx402Arena arena;
+    arena_init_fixed(&arena, buf, cap);
+    int rc = verify_quote_with(client, &arena.allocator, quote, nonce, out);
+    return finish_into(&arena, rc, out, sizeof(*out), out_needed);
+}
 
-    rc = nlx402_verify_quote(client, out_quote, out_quote->nonce, out_verify);
+int nlx402_get_paid_access_into(
+    Nlx402Client *client,
+    const char *tx,
+    const char *nonce,
+    PaidAccessResponse *out,
+    void *buf,
+    size_t cap,
+    size_t *out_needed
+) {
+    Nlx402Arena arena;
+    arena_init_fixed(&arena, buf, cap);
+    int rc = get_paid_access_with(client, &arena.allocator, tx, nonce, out, NULL);
+    rc = finish_into(&arena, rc, out, sizeof(*out), out_needed);
+    if (rc == 0) out->allocator = &borrowed_allocator;
     return rc;
 }
 
+
+/* Batch results are columnar: one contiguous array per scalar field and, per
+ * string field, an offsets array of count + 1 entries into packed,
+ * NUL-terminated data (item i is data + offsets[i]). Everything lives in one
+ * block released by the matching nlx402_free_*_batch. */
+typedef struct {
+    size_t offset;
+    int is_inline;
+} BatchColumn;
+
+static const char *batch_field(const void *item, const BatchColumn *col) {
+    const char *base = (const char *)item + col->offset;
+    const char *value = col->is_inline ? base : *(const char *const *)base;
+    return value ? value : "";
+}
+
+static size_t batch_align(size_t n) {
+    return (n + sizeof(double) - 1) & ~(sizeof(double) - 1);
+}
+
+/* Allocates the batch block: fixed_bytes of scalar columns first, then the
+ * offsets of every string column, then the string data. */
+static unsigned char *batch_pack(
+    const Nlx402Allocator *a,
+    const void *items,
+    size_t item_size,
+    size_t count,
+    const BatchColumn *cols,
+    Nlx402StrColumn *const *out_cols,
+    size_t ncols,
+    size_t fixed_bytes
+) {
+    size_t data_bytes = 0;
+    for (size_t c = 0; c < ncols; c++) {
+        for (size_t i = 0; i < count; i++) {
+            data_bytes += strlen(batch_field((const char *)items + i * item_size, &cols[c])) + 1;
+        }
+    }
+    if (data_bytes > 0xffffffffu) return NULL;
+
+    size_t offsets_bytes = ncols * (count + 1) * sizeof(unsigned int);
+    unsigned char *block = (unsigned char *)mem_alloc(a, NLX402_MEM_RESPONSES,
+                                                      batch_align(fixed_bytes) + offsets_bytes + data_bytes);
+    if (!block) return NULL;
+
+    unsigned int *offsets = (unsigned int *)(block + batch_align(fixed_bytes));
+    char *data = (char *)(offsets + ncols * (count + 1));
+    unsigned int pos = 0;
+    for (size_t c = 0; c < ncols; c++) {
+        out_cols[c]->offsets = offsets + c * (count + 1);
+        out_cols[c]->data = data;
+        for (size_t i = 0; i < count; i++) {
+            const char *value = batch_field((const char *)items + i * item_size, &cols[c]);
+            size_t len = strlen(value) + 1;
+            out_cols[c]->offsets[i] = pos;
+            memcpy(data + pos, value, len);
+            pos += (unsigned int)len;
+        }
+        out_cols[c]->offsets[count] = pos;
+    }
+    return block;
+}
+
+int nlx402_get_quote_batch(Nlx402Client *client, const double *prices, size_t count, Nlx402QuoteBatch *out) {
+    static const BatchColumn cols[] = {
+        { offsetof(QuoteResponse, amount), 0 },
+        { offsetof(QuoteResponse, chain), 0 },
+        { offsetof(QuoteResponse, mint), 1 },
+        { offsetof(QuoteResponse, network), 0 },
+        { offsetof(QuoteResponse, nonce), 1 },
+        { offsetof(QuoteResponse, raw), 0 },
+        { offsetof(QuoteResponse, recipient), 1 },
+        { offsetof(QuoteResponse, version), 0 },
+    };
+    Nlx402StrColumn *const out_cols[] = {
+        &out->amount, &out->chain, &out->mint, &out->network, &out->nonce, &out->raw, &out->recipient,
+        &out->version,
+    };
+
+    memset(out, 0, sizeof(*out));
+    Nlx402Flow flow;
+    if (nlx402_flow_begin(&flow, client, 0) != 0) return -1;
+    const Nlx402Allocator *scratch = &flow.arena.allocator;
+
+    QuoteResponse *items = (QuoteResponse *)mem_calloc(scratch, NLX402_MEM_FLOWS, count ? count : 1, sizeof(*items));
+    long *statuses = (long *)mem_calloc(scratch, NLX402_MEM_FLOWS, count ? count : 1, sizeof(long));
+    int *results = (int *)mem_calloc(scratch, NLX402_MEM_FLOWS, count ? count : 1, sizeof(int));
+    if (!items || !statuses || !results) {
+        nlx402_flow_end(&flow);
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        results[i] = get_quote_with(client, scratch, prices ? prices[i] : 0.0, &items[i], &statuses[i]);
+        if (results[i] != 0) memset(&items[i], 0, sizeof(items[i]));
+    }
+
+    size_t fixed = count * (sizeof(unsigned long long) + sizeof(double) + sizeof(long) + 2 * sizeof(int));
+    unsigned char *block = batch_pack(&client->allocator, items, sizeof(*items), count,
+                                      cols, out_cols, sizeof(cols) / sizeof(cols[0]), fixed);
+    if (!block) {
+        nlx402_flow_end(&flow);
+        memset(out, 0, sizeof(*out));
+        return -1;
+    }
+
+    out->count = count;
+    out->block = block;
+    out->allocator = &client->allocator;
+    out->amount_units = (unsigned long long *)block;
+    out->expires_at = (double *)(out->amount_units + count);
+    out->http_status = (long *)(out->expires_at + count);
+    out->result = (int *)(out->http_status + count);
+    out->decimals = out->result + count;
+    for (size_t i = 0; i < count; i++) {
+        /* An amount that is there but does not parse fails its item. */
+        if (results[i] == 0 && items[i].amount && !items[i].amount_exact) results[i] = NLX402_ERR_AMOUNT;
+        out->amount_units[i] = items[i].amount_units;
+        out->expires_at[i] = items[i].expires_at;
+        out->http_status[i] = statuses[i];
+        out->result[i] = results[i];
+        out->decimals[i] = items[i].decimals;
+    }
+
+    nlx402_flow_end(&flow);
+    return 0;
+}
+
+void nlx402_free_quote_batch(Nlx402QuoteBatch *b) {
+    if (!b) return;
+    mem_free(allocator_or_default(b->allocator), b->block);
+    memset(b, 0, sizeof(*b));
+}
+
+int nlx402_get_paid_access_batch(
+    Nlx402Client *client,
+    const char *const *txs,
+    const char *const *nonces,
+    size_t count,
+    Nlx402PaidAccessBatch *out
+) {
+    static const BatchColumn cols[] = {
+        { offsetof(PaidAccessResponse, amount), 0 },
+        { offsetof(PaidAccessResponse, mint), 1 },
+        { offsetof(PaidAccessResponse, nonce), 1 },
+        { offsetof(PaidAccessResponse, status), 0 },
+        { offsetof(PaidAccessResponse, tx), 1 },
+        { offsetof(PaidAccessResponse, version), 0 },
+    };
+    Nlx402StrColumn *const out_cols[] = {
+        &out->amount, &out->mint, &out->nonce, &out->status, &out->tx, &out->version,
+    };
+
+    memset(out, 0, sizeof(*out));
+    if (count > 0 && (!txs || !nonces)) return -1;
+    Nlx402Flow flow;
+    if (nlx402_flow_begin(&flow, client, 0) != 0) return -1;
+    const Nlx402Allocator *scratch = &flow.arena.allocator;
+
+    PaidAccessResponse *items = (PaidAccessResponse *)mem_calloc(scratch, NLX402_MEM_FLOWS, count ? count : 1, sizeof(*items));
+    long *statuses = (long *)mem_calloc(scratch, NLX402_MEM_FLOWS, count ? count : 1, sizeof(long));
+    int *results = (int *)mem_calloc(scratch, NLX402_MEM_FLOWS, count ? count : 1, sizeof(int));
+    if (!items || !statuses || !results) {
+        nlx402_flow_end(&flow);
+        return -1;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        results[i] = get_paid_access_with(client, scratch, txs[i], nonces[i], &items[i], &statuses[i]);
+        if (results[i] != 0) memset(&items[i], 0, sizeof(items[i]));
+    }
+
+    size_t fixed = count * (sizeof(unsigned long long) + sizeof(long) + 3 * sizeof(int));
+    unsigned char *block = batch_pack(&client->allocator, items, sizeof(*items), count,
+                                      cols, out_cols, sizeof(cols) / sizeof(cols[0]), fixed);
+    if (!block) {
+        nlx402_flow_end(&flow);
+        memset(out, 0, sizeof(*out));
+        return -1;
+    }
+
+    out->count = count;
+    out->block = block;
+    out->allocator = &client->allocator;
+    out->amount_units = (unsigned long long *)block;
+    out->http_status = (long *)(out->amount_units + count);
+    out->result = (int *)(out->http_status + count);
+    out->ok = out->result + count;
+    out->decimals = out->ok + count;
+    for (size_t i = 0; i < count; i++) {
+        if (results[i] == 0 && items[i].amount && !items[i].amount_exact) results[i] = NLX402_ERR_AMOUNT;
+        out->amount_units[i] = items[i].amount_units;
+        out->http_status[i] = statuses[i];
+        out->result[i] = results[i];
+        out->ok[i] = items[i].ok;
+        out->decimals[i] = items[i].decimals;
+    }
+
+    nlx402_flow_end(&flow);
+    return 0;
+}
+
+void nlx402_free_paid_access_batch(Nlx402PaidAccessBatch *b) {
+    if (!b) return;
+    mem_free(allocator_or_default(b->allocator), b->block);
+    memset(b, 0, sizeof(*b));
+}
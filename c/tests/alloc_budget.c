@@ -0,0 +1,62 @@
+/* Holds the payment path to the allocation budgets in nlx402.c: runs each
+ * flow N times against the mock after a warm-up and fails, listing the
+ * allocation sites, if a flow averages more SDK allocations than its budget.
+ * The client and libcurl both allocate through the counting allocator;
+ * libcurl's share is printed but not held to anything. Built with
+ * -DNLX402_ALLOC_TRACE. */
+#include "../nlx402.c"
+#include "mock.h"
+
+#define CALLS 200
+#define TX "5VERv8NMvzbJMEkV8xnrLkEaWRtSz9CosKDYjCJjBRnbJLgp8uirBgmQpjKhoR4tjF3ZpRzrFmBV6UjKdiSZkQUW"
+
+static int quote_and_verify(Nlx402Client *client) {
+    QuoteResponse quote;
+    VerifyResponse verify;
+    int rc = nlx402_get_and_verify_quote(client, 0.5, &quote, &verify);
+    if (rc == 0 && !verify.ok) rc = -1;
+    nlx402_free_quote(&quote);
+    return rc;
+}
+
+static int paid_access(Nlx402Client *client) {
+    PaidAccessResponse paid;
+    int rc = nlx402_get_paid_access(client, TX, "3f1c9a7e5b2d4c6a8e0f1b3d5c7a9e2f", &paid);
+    if (rc == 0) nlx402_free_paid_access(&paid);
+    return rc;
+}
+
+static int check(const char *name, int (*flow)(Nlx402Client *), Nlx402Client *client, unsigned long long budget) {
+    nlx402_alloc_trace_reset();
+    for (int i = 0; i < CALLS; i++) {
+        if (flow(client) != 0) {
+            fprintf(stderr, "%s: call %d failed\n", name, i);
+            return -1;
+        }
+    }
+    unsigned long long curl = nlx402_alloc_trace_curl();
+    printf("%s: %.1f allocations per call (budget %llu), %.1f more by libcurl\n", name,
+           (double)(nlx402_alloc_trace_total() - curl) / CALLS, budget, (double)curl / CALLS);
+    return nlx402_alloc_trace_check(CALLS, budget, stderr);
+}
+
+int main(void) {
+    MockServer mock = { 0 };
+    if (mock_start(&mock) != 0) {
+        fprintf(stderr, "mock server failed to start\n");
+        return 1;
+    }
+    nlx402_global_init_mem(CURL_GLOBAL_DEFAULT, nlx402_alloc_trace_allocator());
+    Nlx402Client client;
+    nlx402_client_init_with_allocator(&client, mock.url, "test-key", nlx402_alloc_trace_allocator());
+
+    /* The first calls create the pooled handle and intern the fields. */
+    int rc = quote_and_verify(&client) | paid_access(&client);
+    if (rc == 0) rc = check("get_and_verify_quote", quote_and_verify, &client, NLX402_ALLOC_BUDGET_GET_AND_VERIFY_QUOTE);
+    if (rc == 0) rc = check("get_paid_access", paid_access, &client, NLX402_ALLOC_BUDGET_PAID_ACCESS);
+
+    nlx402_client_cleanup(&client);
+    curl_global_cleanup();
+    mock_stop(&mock);
+    return rc == 0 ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+/* Integer amount strings are base units, decimal ones are whole tokens
+ * scaled by decimals, and both format back to the same value. */
+#include "../nlx402.c"
+
+static int failures;
+
+static void expect(const char *s, int decimals, int rc, unsigned long long units) {
+    unsigned long long v = 0;
+    int got = nlx402_amount_parse(s, decimals, &v);
+    if (got != rc || (rc == 0 && v != units)) {
+        fprintf(stderr, "amount \"%s\" at %d: got %d/%llu, want %d/%llu\n", s, decimals, got, v, rc, units);
+        failures++;
+    }
+}
+
+int main(void) {
+    expect("1", 6, 0, 1);
+    expect("500000", 6, 0, 500000);
+    expect("1.0", 6, 0, 1000000);
+    expect("1.", 6, 0, 1000000);
+    expect("5.", 6, 0, 5000000);
+    expect("0.5", 6, 0, 500000);
+    expect(".5", 6, 0, 500000);
+    expect("0.000001", 6, 0, 1);
+    expect("0.0000010", 6, 0, 1);
+    expect("0.0000001", 6, -1, 0);
+    expect("7", 0, 0, 7);
+    expect("7.0", 0, 0, 7);
+    expect("7.5", 0, -1, 0);
+    expect("18446744073709551615", 0, 0, 18446744073709551615ULL);
+    expect("18446744073709551616", 0, -1, 0);
+    expect("18446744073709.551615", 6, 0, 18446744073709551615ULL);
+    expect("18446744073710", 6, 0, 18446744073710ULL);
+    expect("18446744073710.0", 6, -1, 0);
+    expect("", 6, -1, 0);
+    expect(".", 6, -1, 0);
+    expect("1.2.3", 6, -1, 0);
+    expect("-1", 6, -1, 0);
+    expect("1e6", 6, -1, 0);
+
+    /* Formatting with exactly decimals fraction digits parses back. */
+    unsigned long long samples[] = { 0, 1, 9, 10, 999999, 1000000, 123456789, 18446744073709551615ULL };
+    for (int d = 0; d <= 9; d++) {
+        for (size_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+            char text[64];
+            unsigned long long back = 0;
+            if (nlx402_amount_format(samples[i], d, text, sizeof(text)) == 0 ||
+                nlx402_amount_parse(text, d, &back) != 0 || back != samples[i]) {
+                fprintf(stderr, "round trip %llu at %d failed\n", samples[i], d);
+                failures++;
+            }
+        }
+    }
+    printf("amounts: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
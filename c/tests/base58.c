@@ -0,0 +1,103 @@
+/* The limb-based base58 codec against the textbook one: random round trips
+ * of every length up to NLX402_BASE58_MAX_BYTES with and without leading
+ * zeros, known vectors, and inputs that must be refused. */
+#include "../nlx402.c"
+#include "base58_ref.h"
+
+#define ROUNDS 200000
+
+static unsigned long long rng = 0x9e3779b97f4a7c15ULL;
+
+static unsigned long long next_random(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+static int failures;
+
+static void fail(const char *what, const unsigned char *in, size_t len) {
+    if (++failures > 10) return;
+    fprintf(stderr, "base58: %s (len %zu):", what, len);
+    for (size_t i = 0; i < len; i++) fprintf(stderr, " %02x", in[i]);
+    fprintf(stderr, "\n");
+}
+
+static void round_trip(const unsigned char *in, size_t len) {
+    char text[200], ref_text[200];
+    unsigned char back[NLX402_BASE58_MAX_BYTES];
+    size_t n = nlx402_base58_encode(in, len, text, sizeof(text));
+    size_t ref_n = ref_base58_encode(in, len, ref_text, sizeof(ref_text));
+    if (n != ref_n || strcmp(text, ref_text) != 0) {
+        fail("encoding differs from the reference", in, len);
+        return;
+    }
+    if (len == 0) return;
+    if (nlx402_base58_decode(text, n, back, len) != 0 || memcmp(back, in, len) != 0) {
+        fail("decode did not round-trip", in, len);
+    }
+    if (ref_base58_decode(text, n, back, len) != 0 || memcmp(back, in, len) != 0) {
+        fail("reference decode disagrees", in, len);
+    }
+    if (nlx402_base58_decode(text, n, back, len - 1) == 0) fail("decoded into a shorter buffer", in, len);
+    if (len < NLX402_BASE58_MAX_BYTES && nlx402_base58_decode(text, n, back, len + 1) == 0) {
+        fail("decoded into a longer buffer", in, len);
+    }
+    if (n > 1 && nlx402_base58_encode(in, len, text, n) != 0) fail("encoded past cap", in, len);
+}
+
+int main(void) {
+    unsigned char in[NLX402_BASE58_MAX_BYTES];
+
+    for (int r = 0; r < ROUNDS; r++) {
+        size_t len = (size_t)(next_random() % (NLX402_BASE58_MAX_BYTES + 1));
+        for (size_t i = 0; i < len; i++) in[i] = (unsigned char)next_random();
+        size_t zeros = len ? (size_t)(next_random() % 4 == 0 ? next_random() % (len + 1) : 0) : 0;
+        memset(in, 0, zeros);
+        round_trip(in, len);
+    }
+    for (size_t len = 1; len <= NLX402_BASE58_MAX_BYTES; len++) {
+        memset(in, 0, len);
+        round_trip(in, len);
+        memset(in, 0xff, len);
+        round_trip(in, len);
+        in[0] = 0;
+        in[len - 1] = 1;
+        round_trip(in, len);
+    }
+
+    static const struct {
+        const char *text;
+        const char *hex;
+    } vectors[] = {
+        { "2NEpo7TZRRrLZSi2U", "48656c6c6f20576f726c6421" },
+        { "111233QC4", "000000287fb4cd" },
+        { "1", "00" },
+        { "5Q", "ff" },
+        { "11111111111111111111111111111111", "0000000000000000000000000000000000000000000000000000000000000000" },
+    };
+    for (size_t v = 0; v < sizeof(vectors) / sizeof(vectors[0]); v++) {
+        size_t len = strlen(vectors[v].hex) / 2;
+        for (size_t i = 0; i < len; i++) sscanf(vectors[v].hex + 2 * i, "%2hhx", &in[i]);
+        char text[200];
+        unsigned char back[NLX402_BASE58_MAX_BYTES];
+        if (nlx402_base58_encode(in, len, text, sizeof(text)) == 0 || strcmp(text, vectors[v].text) != 0 ||
+            nlx402_base58_decode(vectors[v].text, strlen(vectors[v].text), back, len) != 0 ||
+            memcmp(back, in, len) != 0) {
+            fail(vectors[v].text, in, len);
+        }
+    }
+
+    static const char *invalid[] = { "0", "O", "I", "l", "+", "2NEpo7TZRRrLZSi2U ", "2NEpo7TZ-RRrLZSi2U" };
+    for (size_t v = 0; v < sizeof(invalid) / sizeof(invalid[0]); v++) {
+        if (nlx402_base58_decode(invalid[v], strlen(invalid[v]), in, 12) == 0) {
+            fail(invalid[v], NULL, 0);
+        }
+    }
+    if (nlx402_base58_decode("2NE\0po7TZRRrLZSi2U", 18, in, 12) == 0) fail("embedded NUL accepted", NULL, 0);
+    if (nlx402_base58_decode("1", 1, in, 0) == 0) fail("empty output accepted", NULL, 0);
+
+    printf("base58: %d random round trips, %d failures\n", ROUNDS, failures);
+    return failures ? 1 : 0;
+}
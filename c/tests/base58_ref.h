@@ -0,0 +1,61 @@
+/* Textbook base58: one multiply or divide by 58 per digit over a byte
+ * array. The reference the limb codec in nlx402.c is tested and
+ * benchmarked against. */
+#ifndef NLX402_BASE58_REF_H
+#define NLX402_BASE58_REF_H
+
+#include <string.h>
+
+static const char ref_b58_alphabet[] = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+static size_t ref_base58_encode(const unsigned char *in, size_t len, char *out, size_t cap) {
+    unsigned char digits[200] = {0};
+    size_t ndigits = 0, zeros = 0;
+    while (zeros < len && in[zeros] == 0) zeros++;
+    for (size_t i = zeros; i < len; i++) {
+        unsigned int carry = in[i];
+        for (size_t j = 0; j < ndigits; j++) {
+            carry += (unsigned int)digits[j] << 8;
+            digits[j] = (unsigned char)(carry % 58);
+            carry /= 58;
+        }
+        while (carry) {
+            digits[ndigits++] = (unsigned char)(carry % 58);
+            carry /= 58;
+        }
+    }
+    if (zeros + ndigits + 1 > cap) return 0;
+    size_t n = 0;
+    for (size_t i = 0; i < zeros; i++) out[n++] = '1';
+    while (ndigits > 0) out[n++] = ref_b58_alphabet[digits[--ndigits]];
+    out[n] = '\0';
+    return n;
+}
+
+/* Decodes into exactly out_len bytes, like nlx402_base58_decode. */
+static int ref_base58_decode(const char *in, size_t len, unsigned char *out, size_t out_len) {
+    unsigned char bytes[200] = {0};
+    size_t nbytes = 0, ones = 0;
+    while (ones < len && in[ones] == '1') ones++;
+    for (size_t i = ones; i < len; i++) {
+        const char *p = memchr(ref_b58_alphabet, in[i], 58);
+        if (!p || !in[i]) return -1;
+        unsigned int carry = (unsigned int)(p - ref_b58_alphabet);
+        for (size_t j = 0; j < nbytes; j++) {
+            carry += bytes[j] * 58u;
+            bytes[j] = (unsigned char)carry;
+            carry >>= 8;
+        }
+        while (carry) {
+            if (nbytes == sizeof(bytes)) return -1;
+            bytes[nbytes++] = (unsigned char)carry;
+            carry >>= 8;
+        }
+    }
+    if (ones + nbytes != out_len) return -1;
+    memset(out, 0, ones);
+    for (size_t i = 0; i < nbytes; i++) out[ones + i] = bytes[nbytes - 1 - i];
+    return 0;
+}
+
+#endif
@@ -0,0 +1,153 @@
+/* Batches hold the same values as the per-item calls, column by column,
+ * including each quote's raw body, which verifies like a single quote's. An
+ * item that fails leaves its result set and its fields empty without
+ * failing the batch, an amount that does not parse fails its item, and
+ * freeing a batch returns all response memory. */
+#include "../nlx402.c"
+#include "mock.h"
+
+#define TX "5VERv8NMvzbJMEkV8xnrLkEaWRtSz9CosKDYjCJjBRnbJLgp8uirBgmQpjKhoR4tjF3ZpRzrFmBV6UjKdiSZkQUW"
+/* Longer than NLX402_SIGNATURE_MAX, so the echoed tx does not fit. */
+#define TX_OVERSIZED TX "5VERv8NMvzbJMEkV8xnr"
+
+static int failures;
+
+static void expect(int ok, const char *what, size_t i) {
+    if (!ok) {
+        fprintf(stderr, "item %zu: %s\n", i, what);
+        failures++;
+    }
+}
+
+static const char *column(const Nlx402StrColumn *c, size_t i) {
+    return c->data + c->offsets[i];
+}
+
+static int same(const Nlx402StrColumn *c, size_t i, const char *want) {
+    return strcmp(column(c, i), want ? want : "") == 0;
+}
+
+/* The batch item's raw body with its nonce swapped for the per-item call's,
+ * which is all that differs between two quotes for the same price. */
+static int same_raw(const Nlx402QuoteBatch *b, size_t i, const QuoteResponse *q) {
+    const char *raw = column(&b->raw, i);
+    const char *nonce = column(&b->nonce, i);
+    const char *at = strstr(raw, nonce);
+    size_t len = b->raw.offsets[i + 1] - b->raw.offsets[i] - 1;
+    if (!q->raw || !at || len != q->raw_len || strlen(nonce) != strlen(q->nonce)) return 0;
+    size_t pre = (size_t)(at - raw);
+    return memcmp(raw, q->raw, pre) == 0 && memcmp(q->raw + pre, q->nonce, strlen(nonce)) == 0 &&
+           strcmp(at + strlen(nonce), q->raw + pre + strlen(nonce)) == 0;
+}
+
+static size_t responses_held(Nlx402Client *client) {
+    Nlx402MemStats st;
+    nlx402_client_mem_stats(client, &st);
+    return st.by_category[NLX402_MEM_RESPONSES].current;
+}
+
+static void check_quotes(Nlx402Client *client) {
+    static const double prices[] = { 0.5, 1.25, 0.000001, 3 };
+    size_t count = sizeof(prices) / sizeof(prices[0]);
+    Nlx402QuoteBatch b;
+    expect(nlx402_get_quote_batch(client, prices, count, &b) == 0 && b.count == count, "quote batch failed", 0);
+
+    for (size_t i = 0; i < b.count; i++) {
+        QuoteResponse q;
+        expect(nlx402_get_quote(client, prices[i], &q) == 0, "per-item quote failed", i);
+        expect(b.result[i] == 0 && b.http_status[i] == 200, "result or status", i);
+        expect(same(&b.amount, i, q.amount) && same(&b.chain, i, q.chain) && same(&b.mint, i, q.mint) &&
+               same(&b.network, i, q.network) && same(&b.recipient, i, q.recipient) &&
+               same(&b.version, i, q.version), "string column differs from nlx402_get_quote", i);
+        expect(b.amount_units[i] != 0 && b.amount_units[i] == q.amount_units && b.decimals[i] == q.decimals &&
+               b.expires_at[i] == q.expires_at, "scalar column differs from nlx402_get_quote", i);
+        /* Every quote gets a fresh nonce; it only has to be there and distinct. */
+        expect(strlen(column(&b.nonce, i)) == strlen(q.nonce) && !same(&b.nonce, i, q.nonce), "nonce", i);
+        expect(i == 0 || strcmp(column(&b.nonce, i), column(&b.nonce, i - 1)) != 0, "repeated nonce", i);
+        expect(same_raw(&b, i, &q), "raw column differs from nlx402_get_quote", i);
+        nlx402_free_quote(&q);
+
+        QuoteResponse item = { 0 };
+        VerifyResponse v;
+        snprintf(item.nonce, sizeof(item.nonce), "%s", column(&b.nonce, i));
+        item.raw = (char *)column(&b.raw, i);
+        item.raw_len = b.raw.offsets[i + 1] - b.raw.offsets[i] - 1;
+        expect(nlx402_verify_quote(client, &item, item.nonce, &v) == 0 && v.ok, "raw column did not verify", i);
+    }
+
+    expect(responses_held(client) > 0, "batch not counted as response memory", 0);
+    nlx402_free_quote_batch(&b);
+    expect(responses_held(client) == 0 && !b.block && b.count == 0, "quote batch left response memory", 0);
+
+    expect(nlx402_get_quote_batch(client, NULL, 0, &b) == 0 && b.count == 0, "empty quote batch failed", 0);
+    nlx402_free_quote_batch(&b);
+    expect(responses_held(client) == 0, "empty quote batch left response memory", 0);
+}
+
+static void check_paid_access(Nlx402Client *client) {
+    static const char *const txs[] = { TX, TX_OVERSIZED, TX };
+    static const char *const nonces[] = {
+        "3f1c9a7e5b2d4c6a8e0f1b3d5c7a9e2f", "0123456789abcdef0123456789abcdef", "fedcba9876543210fedcba9876543210",
+    };
+    size_t count = sizeof(txs) / sizeof(txs[0]);
+    size_t bad = 1;
+    Nlx402PaidAccessBatch b;
+    expect(nlx402_get_paid_access_batch(client, txs, nonces, count, &b) == 0 && b.count == count,
+           "paid access batch failed", 0);
+
+    for (size_t i = 0; i < b.count; i++) {
+        if (i == bad) {
+            expect(b.result[i] != 0 && b.http_status[i] == 200, "oversized tx did not fail its item", i);
+            expect(!b.ok[i] && b.amount_units[i] == 0 && b.decimals[i] == 0, "failed item kept scalars", i);
+            expect(same(&b.tx, i, "") && same(&b.nonce, i, "") && same(&b.amount, i, "") && same(&b.status, i, ""),
+                   "failed item kept strings", i);
+            continue;
+        }
+        PaidAccessResponse p;
+        expect(nlx402_get_paid_access(client, txs[i], nonces[i], &p) == 0, "per-item paid access failed", i);
+        expect(b.result[i] == 0 && b.http_status[i] == 200, "result or status", i);
+        expect(same(&b.amount, i, p.amount) && same(&b.mint, i, p.mint) && same(&b.nonce, i, p.nonce) &&
+               same(&b.status, i, p.status) && same(&b.tx, i, p.tx) && same(&b.version, i, p.version),
+               "string column differs from nlx402_get_paid_access", i);
+        /* The fixture's "500000" is already base units. */
+        expect(b.ok[i] == p.ok && b.amount_units[i] == 500000 && b.amount_units[i] == p.amount_units &&
+               b.decimals[i] == p.decimals,
+               "scalar column differs from nlx402_get_paid_access", i);
+        nlx402_free_paid_access(&p);
+    }
+
+    nlx402_free_paid_access_batch(&b);
+    expect(responses_held(client) == 0 && !b.block, "paid access batch left response memory", 0);
+}
+
+static void check_bad_amount(Nlx402Client *client, MockServer *mock) {
+    static const char *const txs[] = { TX };
+    static const char *const nonces[] = { "3f1c9a7e5b2d4c6a8e0f1b3d5c7a9e2f" };
+    mock->body = "{\"ok\":true,\"x402\":{\"amount\":\"0.5.0\",\"decimals\":6,\"status\":\"settled\"}}";
+    Nlx402PaidAccessBatch b;
+    expect(nlx402_get_paid_access_batch(client, txs, nonces, 1, &b) == 0 && b.count == 1, "paid access batch failed", 0);
+    expect(b.result[0] == NLX402_ERR_AMOUNT && b.amount_units[0] == 0, "unparsed amount did not fail its item", 0);
+    nlx402_free_paid_access_batch(&b);
+    mock->body = NULL;
+}
+
+int main(void) {
+    MockServer mock = { 0 };
+    if (mock_start(&mock) != 0) {
+        fprintf(stderr, "mock server failed to start\n");
+        return 1;
+    }
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    Nlx402Client client;
+    nlx402_client_init(&client, mock.url, "test-key");
+
+    check_quotes(&client);
+    check_paid_access(&client);
+    check_bad_amount(&client, &mock);
+
+    nlx402_client_cleanup(&client);
+    curl_global_cleanup();
+    mock_stop(&mock);
+    printf("batch: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
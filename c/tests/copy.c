@@ -0,0 +1,94 @@
+/* Copies belong to the client they are copied into: a quote from an _into
+ * buffer or a flow arena outlives that memory, and a copy into a second
+ * client outlives the first. */
+#include "../nlx402.c"
+#include "mock.h"
+
+static int failures;
+
+static void expect(int ok, const char *what) {
+    if (!ok) {
+        fprintf(stderr, "%s\n", what);
+        failures++;
+    }
+}
+
+int main(void) {
+    MockServer mock = { 0 };
+    if (mock_start(&mock) != 0) {
+        fprintf(stderr, "mock server failed to start\n");
+        return 1;
+    }
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    Nlx402Client client;
+    Nlx402Client other;
+    nlx402_client_init(&client, mock.url, "test-key");
+    nlx402_client_init(&other, mock.url, "test-key");
+
+    /* From a caller buffer, which is then overwritten. */
+    static char scratch[8192];
+    size_t needed = 0;
+    QuoteResponse borrowed;
+    QuoteResponse reference;
+    QuoteResponse kept;
+    expect(nlx402_get_quote(&client, 0.5, &reference) == 0, "reference quote failed");
+    expect(nlx402_get_quote_into(&client, 0.5, &borrowed, scratch, sizeof(scratch), &needed) == 0, "_into quote failed");
+    expect(nlx402_copy_quote(&client, &kept, &borrowed) == 0, "copy of an _into quote failed");
+    memset(scratch, 0x5a, sizeof(scratch));
+    expect(kept.allocator == &client.allocator && kept.amount && strcmp(kept.amount, reference.amount) == 0 &&
+           kept.raw && kept.raw_len == reference.raw_len && kept.chain == reference.chain,
+           "copy of an _into quote did not survive its buffer");
+    nlx402_free_quote(&kept);
+
+    /* From a flow, which then ends. */
+    Nlx402Flow flow;
+    QuoteResponse in_flow;
+    VerifyResponse verify;
+    PaidAccessResponse paid_in_flow;
+    PaidAccessResponse paid;
+    nlx402_flow_begin(&flow, &client, 0);
+    expect(nlx402_flow_get_and_verify_quote(&flow, 0.5, &in_flow, &verify) == 0 && verify.ok, "flow quote failed");
+    expect(nlx402_flow_get_paid_access(&flow, "5VERv8NMvzbJMEkV8xnrLkEaWRtSz9CosKDYjCJjBRnbJLgp8uirBgmQpjKhoR4tjF3ZpRzrFmBV6UjKdiSZkQUW",
+                                       in_flow.nonce, &paid_in_flow) == 0, "flow paid access failed");
+    expect(nlx402_copy_quote(&client, &kept, &in_flow) == 0, "copy of a flow quote failed");
+    expect(nlx402_copy_paid_access(&client, &paid, &paid_in_flow) == 0, "copy of flow paid access failed");
+    unsigned long long paid_hash = nlx402_hash_paid_access(&paid_in_flow);
+    nlx402_flow_end(&flow);
+    expect(strcmp(kept.nonce, reference.nonce) != 0 && kept.raw && kept.amount && strcmp(kept.amount, reference.amount) == 0,
+           "copy of a flow quote did not survive the flow");
+    expect(nlx402_hash_paid_access(&paid) == paid_hash && paid.amount && paid.status, "copy of paid access changed");
+    nlx402_free_quote(&kept);
+    nlx402_free_paid_access(&paid);
+
+    /* Into another client, after which the first goes away. */
+    MetadataResponse meta;
+    MetadataResponse meta_copy;
+    expect(nlx402_get_metadata(&client, &meta) == 0, "metadata failed");
+    expect(nlx402_copy_metadata(&other, &meta_copy, &meta) == 0, "copy of metadata failed");
+    expect(nlx402_copy_quote(&other, &kept, &reference) == 0, "copy into another client failed");
+    unsigned long long meta_hash = nlx402_hash_metadata(&meta);
+    expect(meta_copy.supported_mints_count == meta.supported_mints_count && meta_copy.network != meta.network &&
+           meta_copy.network == nlx402_client_intern(&other, "mainnet-beta"),
+           "metadata copy still points into the first client's intern table");
+    nlx402_free_metadata(&meta);
+    nlx402_free_quote(&reference);
+    nlx402_client_cleanup(&client);
+    expect(nlx402_hash_metadata(&meta_copy) == meta_hash, "metadata copy changed after its source client went away");
+    expect(kept.allocator == &other.allocator && kept.raw && kept.chain && strcmp(kept.chain, "solana") == 0,
+           "quote copy did not survive its source client");
+    nlx402_free_metadata(&meta_copy);
+    nlx402_free_quote(&kept);
+
+    /* A copy is not a move: copying onto the source is refused. */
+    expect(nlx402_copy_quote(&other, &kept, &kept) == -1, "copy onto itself was accepted");
+
+    Nlx402MemStats stats;
+    nlx402_client_mem_stats(&other, &stats);
+    expect(stats.by_category[NLX402_MEM_RESPONSES].current == 0, "copies leaked response memory");
+
+    nlx402_client_cleanup(&other);
+    curl_global_cleanup();
+    mock_stop(&mock);
+    printf("copy: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+/* Failed calls: every getter run against malformed or truncated bodies, whole
+ * and streamed in small chunks, fails, leaves its response empty, returns all
+ * response memory, and can be freed again afterwards. */
+#include "../nlx402.c"
+#include "mock.h"
+
+#define TX "5VERv8NMvzbJMEkV8xnrLkEaWRtSz9CosKDYjCJjBRnbJLgp8uirBgmQpjKhoR4tjF3ZpRzrFmBV6UjKdiSZkQUW"
+#define NONCE "3f1c9a7e5b2d4c6a8e0f1b3d5c7a9e2f"
+
+/* Each body carries owned strings and list items before it goes wrong. */
+static const char *const bodies[] = {
+    "{\"ok\":true,\"wallet_id\":\"w-1\",\"amount\":\"500000\",\"supported_mints\":[\"a\",\"b\"],"
+    "\"x402\":{\"amount\":\"500000\",\"status\":\"settled\",\"version\":\"1\"},\"metadata\":{\"network\":\"mainnet\"}]",
+    "{\"ok\":true,\"wallet_id\":\"w-1\",\"amount\":\"500000\",\"supported_mints\":[\"a\",\"b\"],"
+    "\"x402\":{\"amount\":\"500000\",\"status\":\"settled\",\"version\":\"1\"},\"metadata\":{\"network\":\"main",
+    "{\"ok\":true,\"wallet_id\":\"w-1\",\"amount\":\"500000\",\"x402\":{\"status\":\"settled\",\"amount\":tru}}",
+    "{\"ok\":true,\"supported_mints\":[\"a\",\"b\",}",
+};
+
+static int failures;
+static Nlx402Client client;
+static QuoteResponse quote;
+
+static void expect(int ok, const char *what, size_t i, size_t chunk) {
+    if (!ok) {
+        fprintf(stderr, "body %zu, chunk %zu: %s\n", i, chunk, what);
+        failures++;
+    }
+}
+
+static size_t responses_held(void) {
+    Nlx402MemStats st;
+    nlx402_client_mem_stats(&client, &st);
+    return st.by_category[NLX402_MEM_RESPONSES].current;
+}
+
+static void check(size_t i, size_t chunk) {
+    MetadataResponse m;
+    AuthMeResponse a;
+    QuoteResponse q;
+    VerifyResponse v;
+    PaidAccessResponse p;
+
+    expect(nlx402_get_metadata(&client, &m) != 0, "metadata accepted", i, chunk);
+    expect(!m.supported_mints && !m.supported_chains && m.supported_mints_count == 0, "metadata not emptied", i, chunk);
+    nlx402_free_metadata(&m);
+
+    expect(nlx402_get_auth_me(&client, &a) != 0, "auth_me accepted", i, chunk);
+    expect(!a.wallet_id, "auth_me not emptied", i, chunk);
+    nlx402_free_auth_me(&a);
+
+    expect(nlx402_get_quote(&client, 0.5, &q) != 0, "quote accepted", i, chunk);
+    expect(!q.amount && !q.raw && q.raw_len == 0, "quote not emptied", i, chunk);
+    nlx402_free_quote(&q);
+
+    expect(nlx402_verify_quote(&client, &quote, quote.nonce, &v) != 0, "verify accepted", i, chunk);
+
+    expect(nlx402_get_paid_access(&client, TX, NONCE, &p) != 0, "paid access accepted", i, chunk);
+    expect(!p.amount && !p.status, "paid access not emptied", i, chunk);
+    nlx402_free_paid_access(&p);
+
+    expect(responses_held() == 0, "left response memory behind", i, chunk);
+}
+
+int main(void) {
+    MockServer mock = { 0 };
+    if (mock_start(&mock) != 0) {
+        fprintf(stderr, "mock server failed to start\n");
+        return 1;
+    }
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    nlx402_client_init(&client, mock.url, "test-key");
+    /* A hand-built quote, so verify has something to send. */
+    snprintf(quote.nonce, sizeof(quote.nonce), "%s", NONCE);
+
+    static const size_t chunks[] = { 0, 7, 64 };
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        mock.chunk = chunks[c];
+        for (size_t i = 0; i < sizeof(bodies) / sizeof(bodies[0]); i++) {
+            mock.body = bodies[i];
+            check(i, chunks[c]);
+        }
+    }
+
+    nlx402_client_cleanup(&client);
+    curl_global_cleanup();
+    mock_stop(&mock);
+    printf("failures: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,257 @@
+/* Flat buffers round-trip every response the mock serves, and a truncated
+ * or corrupted image is refused rather than read out of bounds: every
+ * accessor and reader is run on every prefix and on every byte changed,
+ * each from an exact-size allocation so a sanitizer sees any overrun. */
+#include "../nlx402.c"
+#include "mock.h"
+
+#define TX "5VERv8NMvzbJMEkV8xnrLkEaWRtSz9CosKDYjCJjBRnbJLgp8uirBgmQpjKhoR4tjF3ZpRzrFmBV6UjKdiSZkQUW"
+
+static int failures;
+static Nlx402Client client;
+
+static void expect(int ok, const char *what) {
+    if (!ok && failures++ < 20) fprintf(stderr, "%s\n", what);
+}
+
+static void path_of(const ResponseSchema *sc, const ResponseField *f, char *out, size_t cap) {
+    if (f->parent == JSON_ROOT || f->parent == JSON_SKIP) snprintf(out, cap, "%s", f->name);
+    else snprintf(out, cap, "%s.%s", sc->fields[f->parent - JSON_ROOT - 1].name, f->name);
+}
+
+static int inside(const unsigned char *b, size_t len, Nlx402View v) {
+    const unsigned char *p = (const unsigned char *)v.ptr;
+    return p >= b && p <= b + len && v.len < len && (size_t)(p - b) + v.len < len && p[v.len] == '\0';
+}
+
+/* Runs every accessor on every field; returns how many succeeded. Any view
+ * handed out must lie in the buffer and end in a NUL. */
+static int access_all(const ResponseSchema *sc, const unsigned char *b, size_t len) {
+    int ok = 0;
+    char path[64];
+    Nlx402View v;
+    for (int i = 0; i < sc->count; i++) {
+        const ResponseField *f = &sc->fields[i];
+        path_of(sc, f, path, sizeof(path));
+        int flag;
+        double d;
+        switch (f->kind) {
+        case F_BOOL:
+            ok += nlx402_flat_bool(b, len, path, &flag) == 0;
+            break;
+        case F_INT:
+        case F_NUMBER:
+            ok += nlx402_flat_number(b, len, path, &d) == 0;
+            break;
+        case F_OBJECT:
+            ok += nlx402_flat_string(b, len, path, &v) == 0;
+            break;
+        case F_LIST: {
+            int count = nlx402_flat_count(b, len, path);
+            ok += count >= 0;
+            for (int k = -1; k <= count; k++) {
+                if (nlx402_flat_string_at(b, len, path, k, &v) == 0) {
+                    ok++;
+                    expect(k >= 0 && k < count, "list item outside the count");
+                    expect(inside(b, len, v), "list item outside the buffer");
+                }
+            }
+            break;
+        }
+        default:
+            if (nlx402_flat_string(b, len, path, &v) == 0) {
+                ok++;
+                expect(inside(b, len, v), "string outside the buffer");
+            }
+        }
+    }
+    return ok;
+}
+
+static int read_back(int type, const unsigned char *b, size_t len) {
+    union {
+        MetadataResponse metadata;
+        QuoteResponse quote;
+        PaidAccessResponse paid;
+    } out;
+    int rc = -1;
+    switch (type) {
+    case NLX402_FLAT_METADATA:
+        rc = nlx402_flat_read_metadata(&client, b, len, &out.metadata);
+        if (rc == 0) nlx402_free_metadata(&out.metadata);
+        break;
+    case NLX402_FLAT_QUOTE:
+        rc = nlx402_flat_read_quote(&client, b, len, &out.quote);
+        if (rc == 0) nlx402_free_quote(&out.quote);
+        break;
+    case NLX402_FLAT_PAID_ACCESS:
+        rc = nlx402_flat_read_paid_access(&client, b, len, &out.paid);
+        if (rc == 0) nlx402_free_paid_access(&out.paid);
+        break;
+    }
+    return rc;
+}
+
+/* Every prefix is refused; every byte changed is either refused or read
+ * within bounds. */
+static void damage(const char *name, int type, const unsigned char *flat, size_t n) {
+    const ResponseSchema *sc = flat_schemas[type];
+    for (size_t cut = 0; cut < n; cut++) {
+        unsigned char *b = (unsigned char *)malloc(cut ? cut : 1);
+        memcpy(b, flat, cut);
+        if (nlx402_flat_type(b, cut) != -1 || access_all(sc, b, cut) != 0 || read_back(type, b, cut) != -1) {
+            if (failures++ < 20) fprintf(stderr, "%s cut to %zu of %zu bytes was read\n", name, cut, n);
+        }
+        free(b);
+    }
+
+    static const unsigned char values[] = { 0x00, 0x01, 0x04, 0x10, 0x7f, 0x80, 0xfe, 0xff };
+    unsigned long long changes = 0;
+    unsigned char *b = (unsigned char *)malloc(n);
+    for (size_t at = 0; at < n; at++) {
+        for (size_t k = 0; k <= sizeof(values); k++) {
+            memcpy(b, flat, n);
+            b[at] = k < sizeof(values) ? values[k] : (unsigned char)(flat[at] ^ 0x80);
+            if (b[at] == flat[at]) continue;
+            access_all(sc, b, n);
+            read_back(type, b, n);
+            changes++;
+        }
+    }
+    free(b);
+    printf("flat: %s, %zu bytes, %zu prefixes, %llu changed bytes\n", name, n, n, changes);
+}
+
+int main(void) {
+    MockServer mock = { 0 };
+    if (mock_start(&mock) != 0) {
+        fprintf(stderr, "mock server failed to start\n");
+        return 1;
+    }
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    nlx402_client_init(&client, mock.url, "test-key");
+
+    MetadataResponse meta;
+    QuoteResponse quote;
+    PaidAccessResponse paid;
+    expect(nlx402_get_metadata(&client, &meta) == 0, "metadata failed");
+    expect(nlx402_get_quote(&client, 0.5, &quote) == 0, "quote failed");
+    expect(nlx402_get_paid_access(&client, TX, quote.nonce, &paid) == 0, "paid access failed");
+
+    /* Size only, too small, and exact. */
+    size_t n = nlx402_flat_write_quote(&quote, NULL, 0);
+    unsigned char *flat = (unsigned char *)malloc(n);
+    expect(n > FLAT_HEADER && n % 4 == 0, "quote flat size");
+    expect(nlx402_flat_write_quote(&quote, flat, n - 1) == 0, "quote written into too small a buffer");
+    expect(nlx402_flat_write_quote(&quote, flat, n) == n, "quote flat write failed");
+    expect(nlx402_flat_type(flat, n) == NLX402_FLAT_QUOTE, "quote flat type");
+
+    /* Accessors and the reader give back what was written. */
+    Nlx402View v;
+    double d;
+    expect(nlx402_flat_string(flat, n, "nonce", &v) == 0 && v.len == strlen(quote.nonce) &&
+           memcmp(v.ptr, quote.nonce, v.len) == 0, "quote nonce");
+    expect(nlx402_flat_string(flat, n, "raw", &v) == 0 && v.len == quote.raw_len &&
+           memcmp(v.ptr, quote.raw, v.len) == 0, "quote raw body");
+    expect(nlx402_flat_number(flat, n, "decimals", &d) == 0 && d == quote.decimals, "quote decimals");
+    expect(nlx402_flat_number(flat, n, "expires_at", &d) == 0 && d == quote.expires_at, "quote expires_at");
+    expect(nlx402_flat_string(flat, n, "decimals", &v) == -1, "decimals read as a string");
+    expect(nlx402_flat_string(flat, n, "missing", &v) == -1, "unknown path read");
+    QuoteResponse again;
+    expect(nlx402_flat_read_quote(&client, flat, n, &again) == 0, "quote flat read failed");
+    expect(nlx402_hash_quote(&again) == nlx402_hash_quote(&quote) && again.amount_units == quote.amount_units &&
+           again.keys_valid == quote.keys_valid && again.chain == quote.chain, "quote changed through a flat buffer");
+    nlx402_free_quote(&again);
+    MetadataResponse wrong;
+    expect(nlx402_flat_read_metadata(&client, flat, n, &wrong) == -1, "quote read as metadata");
+    damage("quote", NLX402_FLAT_QUOTE, flat, n);
+    free(flat);
+
+    /* A later version that appends a field and its record reads the same. */
+    static ResponseField later_fields[sizeof(quote_fields) / sizeof(quote_fields[0]) + 1];
+    memcpy(later_fields, quote_fields, sizeof(quote_fields));
+    ResponseField *added = &later_fields[quote_schema.count];
+    *added = quote_fields[Q_AMOUNT - JSON_ROOT - 1];
+    added->name = "amount_text";
+    added->len = 11;
+    added->slot = (unsigned char)(quote_schema.count + JSON_ROOT + 1);
+    ResponseSchema later = quote_schema;
+    later.fields = later_fields;
+    later.count++;
+    n = flat_write(&later, NLX402_FLAT_QUOTE, &quote, NULL, 0);
+    flat = (unsigned char *)malloc(n);
+    expect(flat_write(&later, NLX402_FLAT_QUOTE, &quote, flat, n) == n, "later quote flat write failed");
+    flat_put_u16(flat + 4, NLX402_FLAT_VERSION + 1);
+    expect(nlx402_flat_type(flat, n) == NLX402_FLAT_QUOTE, "later version refused");
+    expect(nlx402_flat_string(flat, n, "nonce", &v) == 0 && strcmp(v.ptr, quote.nonce) == 0, "later version nonce");
+    expect(nlx402_flat_string(flat, n, "amount_text", &v) == -1, "unknown later field read");
+    expect(nlx402_flat_read_quote(&client, flat, n, &again) == 0 && nlx402_hash_quote(&again) == nlx402_hash_quote(&quote),
+           "later version read differently");
+    nlx402_free_quote(&again);
+    free(flat);
+
+    n = nlx402_flat_write_metadata(&meta, NULL, 0);
+    flat = (unsigned char *)malloc(n);
+    expect(nlx402_flat_write_metadata(&meta, flat, n) == n, "metadata flat write failed");
+    int ok = 0;
+    expect(nlx402_flat_bool(flat, n, "ok", &ok) == 0 && ok == meta.ok, "metadata ok");
+    expect(nlx402_flat_string(flat, n, "metadata.network", &v) == 0 && strcmp(v.ptr, meta.network) == 0,
+           "metadata network");
+    expect(nlx402_flat_count(flat, n, "supported_mints") == meta.supported_mints_count, "metadata mint count");
+    expect(nlx402_flat_count(flat, n, "metadata.supported_chains") == meta.supported_chains_count,
+           "metadata chain count");
+    expect(nlx402_flat_string_at(flat, n, "supported_mints", 1, &v) == 0 && strcmp(v.ptr, meta.supported_mints[1]) == 0,
+           "metadata second mint");
+    expect(nlx402_flat_string_at(flat, n, "supported_mints", meta.supported_mints_count, &v) == -1,
+           "mint past the end read");
+    MetadataResponse meta_again;
+    expect(nlx402_flat_read_metadata(&client, flat, n, &meta_again) == 0 &&
+           nlx402_hash_metadata(&meta_again) == nlx402_hash_metadata(&meta), "metadata changed through a flat buffer");
+    nlx402_free_metadata(&meta_again);
+    damage("metadata", NLX402_FLAT_METADATA, flat, n);
+    free(flat);
+
+    n = nlx402_flat_write_paid_access(&paid, NULL, 0);
+    flat = (unsigned char *)malloc(n);
+    expect(nlx402_flat_write_paid_access(&paid, flat, n) == n, "paid access flat write failed");
+    expect(nlx402_flat_string(flat, n, "x402.tx", &v) == 0 && strcmp(v.ptr, TX) == 0, "paid access tx");
+    PaidAccessResponse paid_again;
+    expect(nlx402_flat_read_paid_access(&client, flat, n, &paid_again) == 0 &&
+           nlx402_hash_paid_access(&paid_again) == nlx402_hash_paid_access(&paid),
+           "paid access changed through a flat buffer");
+    nlx402_free_paid_access(&paid_again);
+
+    /* Header fields a reader must check. */
+    unsigned char *bad = (unsigned char *)malloc(n);
+    memcpy(bad, flat, n);
+    bad[4] = 0;
+    expect(nlx402_flat_type(bad, n) == -1, "version 0 accepted");
+    memcpy(bad, flat, n);
+    bad[6] = 9;
+    expect(nlx402_flat_type(bad, n) == -1, "unknown type accepted");
+    memcpy(bad, flat, n);
+    bad[12] = (unsigned char)(paid_access_schema.count - 1);
+    expect(nlx402_flat_type(bad, n) == -1, "too few slots accepted");
+    memcpy(bad, flat, n);
+    flat_put_u32(bad + 8, (unsigned long)n + 4);
+    expect(nlx402_flat_type(bad, n) == -1, "size past the buffer accepted");
+    memcpy(bad, flat, n);
+    flat_put_u32(bad + FLAT_HEADER + FLAT_SLOT * (P_TX - JSON_ROOT - 1), (unsigned long)n - 4);
+    expect(nlx402_flat_string(bad, n, "x402.tx", &v) == -1, "string record past the end read");
+    free(bad);
+    damage("paid access", NLX402_FLAT_PAID_ACCESS, flat, n);
+    free(flat);
+
+    nlx402_free_metadata(&meta);
+    nlx402_free_quote(&quote);
+    nlx402_free_paid_access(&paid);
+    Nlx402MemStats stats;
+    nlx402_client_mem_stats(&client, &stats);
+    expect(stats.by_category[NLX402_MEM_RESPONSES].current == 0, "flat reads leaked response memory");
+
+    nlx402_client_cleanup(&client);
+    curl_global_cleanup();
+    mock_stop(&mock);
+    printf("flat: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,33 @@
+/* Content-Length presizes the receive buffer, but never past the size a
+ * handle keeps between requests, however long or large the number is. */
+#include "../nlx402.c"
+
+static int failures;
+
+static void presize(Nlx402Client *client, const char *line, size_t at_least, size_t at_most) {
+    Nlx402Handle h = { 0 };
+    h.allocator = &client->allocator;
+    char buf[128];
+    size_t n = (size_t)snprintf(buf, sizeof(buf), "%s", line);
+    if (header_callback(buf, 1, n, &h) != n || h.recv_cap < at_least || h.recv_cap > at_most) {
+        fprintf(stderr, "\"%s\": capacity %zu, want %zu to %zu\n", line, h.recv_cap, at_least, at_most);
+        failures++;
+    }
+    mem_free(h.allocator, h.recv);
+}
+
+int main(void) {
+    Nlx402Client client;
+    nlx402_client_init(&client, "http://127.0.0.1:1", "test-key");
+    presize(&client, "Content-Length: 0\r\n", 0, RECV_MIN_CAPACITY);
+    presize(&client, "Content-Length: 5000\r\n", 5000 + JSON_PADDING, 16384);
+    presize(&client, "content-length:\t200000\r\n", 200000 + JSON_PADDING, RECV_RETAIN_MAX);
+    presize(&client, "Content-Length: 262143\r\n", RECV_RETAIN_MAX, RECV_RETAIN_MAX);
+    presize(&client, "Content-Length: 999999\r\n", RECV_RETAIN_MAX, RECV_RETAIN_MAX);
+    presize(&client, "Content-Length: 2621439\r\n", RECV_RETAIN_MAX, RECV_RETAIN_MAX);
+    presize(&client, "Content-Length: 99999999999999999999999999999999\r\n", RECV_RETAIN_MAX, RECV_RETAIN_MAX);
+    presize(&client, "Content-Length: 18446744073709551617\r\n", RECV_RETAIN_MAX, RECV_RETAIN_MAX);
+    nlx402_client_cleanup(&client);
+    printf("headers: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+/* Interned fields that do not get into the table, because it is full or the
+ * value is too long, become copies owned by their response instead of
+ * failing it: the values read the same, a list switches to copies as a
+ * whole, copies of copies work, and freeing returns all response memory. */
+#include "../nlx402.c"
+#include "mock.h"
+
+static int failures;
+static MockServer mock;
+
+static void expect(int ok, const char *what) {
+    if (!ok) {
+        fprintf(stderr, "%s\n", what);
+        failures++;
+    }
+}
+
+static size_t responses_held(Nlx402Client *client) {
+    Nlx402MemStats st;
+    nlx402_client_mem_stats(client, &st);
+    return st.by_category[NLX402_MEM_RESPONSES].current;
+}
+
+/* Schema index of a metadata slot. */
+#define FIELD(slot) ((slot) - JSON_ROOT - 1)
+
+static int same_metadata(const MetadataResponse *m) {
+    return m->ok && strcmp(m->network, "mainnet-beta") == 0 && strcmp(m->version, "1") == 0 &&
+           m->supported_chains_count == 2 && strcmp(m->supported_chains[0], "solana") == 0 &&
+           strcmp(m->supported_chains[1], "base") == 0 && m->supported_mints_count == 2 &&
+           strcmp(m->supported_mints[0], MOCK_MINT) == 0 &&
+           strcmp(m->supported_mints[1], "Es9vMFrzaCERmJfrF4H2FYD4KCoNkY11McCe8BenwNYB") == 0;
+}
+
+static void check_full_table(Nlx402Client *client, Nlx402Client *other) {
+    /* Room for network, version and the first chain only. */
+    nlx402_client_set_intern_limit(client, 3);
+    nlx402_client_set_intern_limit(other, 1);
+    MetadataResponse m;
+    expect(nlx402_get_metadata(client, &m) == 0, "metadata failed with a full intern table");
+    expect(same_metadata(&m), "metadata values differ");
+    expect(m.network == nlx402_client_intern(client, "mainnet-beta") && !response_is_owned(&metadata_schema, &m, FIELD(M_NETWORK)),
+           "a value that fit was not interned");
+    expect(response_is_owned(&metadata_schema, &m, FIELD(M_CHAINS)) &&
+           response_is_owned(&metadata_schema, &m, FIELD(M_MINTS)) &&
+           m.supported_chains[0] != nlx402_client_intern(client, "solana"), "lists were not copied as a whole");
+    expect(nlx402_client_intern_rejected(client) > 0, "rejections not counted");
+
+    MetadataResponse copy;
+    expect(nlx402_copy_metadata(other, &copy, &m) == 0, "copy into a full table failed");
+    nlx402_free_metadata(&m);
+    expect(responses_held(client) == 0, "full-table metadata left response memory");
+    expect(same_metadata(&copy), "copied metadata values differ");
+    nlx402_free_metadata(&copy);
+    expect(responses_held(other) == 0, "copied metadata left response memory");
+}
+
+static void check_long_value(Nlx402Client *client) {
+    char version[NLX402_INTERN_LEN_MAX + 64];
+    memset(version, 'v', sizeof(version) - 1);
+    version[sizeof(version) - 1] = '\0';
+    static char body[1024];
+    snprintf(body, sizeof(body),
+             "{\"amount\":\"0.5\",\"chain\":\"solana\",\"decimals\":6,\"mint\":\"" MOCK_MINT "\","
+             "\"nonce\":\"3f1c9a7e5b2d4c6a8e0f1b3d5c7a9e2f\",\"version\":\"%s\"}", version);
+    mock.body = body;
+    QuoteResponse q;
+    expect(nlx402_get_quote(client, 0.5, &q) == 0, "quote with a long version failed");
+    expect(q.version && strcmp(q.version, version) == 0 && strcmp(q.chain, "solana") == 0, "long version differs");
+    nlx402_free_quote(&q);
+    expect(responses_held(client) == 0, "long-version quote left response memory");
+    mock.body = NULL;
+}
+
+int main(void) {
+    if (mock_start(&mock) != 0) {
+        fprintf(stderr, "mock server failed to start\n");
+        return 1;
+    }
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    Nlx402Client client;
+    Nlx402Client other;
+    nlx402_client_init(&client, mock.url, "test-key");
+    nlx402_client_init(&other, mock.url, "test-key");
+
+    check_full_table(&client, &other);
+    check_long_value(&other);
+
+    nlx402_client_cleanup(&other);
+    nlx402_client_cleanup(&client);
+    curl_global_cleanup();
+    mock_stop(&mock);
+    printf("interns: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
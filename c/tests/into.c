@@ -0,0 +1,111 @@
+/* The _into variants against a buffer that is too small: the call fails with
+ * NLX402_ERR_BUFFER_TOO_SMALL and an empty response, never touches client
+ * memory, and reports a lower bound on the size it needs; retrying with that
+ * bound makes progress every time and ends in success. Other failures empty
+ * the response too. */
+#include "../nlx402.c"
+#include "mock.h"
+
+#define TX "5VERv8NMvzbJMEkV8xnrLkEaWRtSz9CosKDYjCJjBRnbJLgp8uirBgmQpjKhoR4tjF3ZpRzrFmBV6UjKdiSZkQUW"
+
+static int failures;
+static Nlx402Client client;
+static MockServer mock;
+static QuoteResponse quote;
+static _Alignas(ARENA_ALIGN) char scratch[16384];
+
+static void expect(int ok, const char *what) {
+    if (!ok) {
+        fprintf(stderr, "%s\n", what);
+        failures++;
+    }
+}
+
+static int quote_into(size_t cap, size_t *needed) {
+    QuoteResponse q;
+    int rc = nlx402_get_quote_into(&client, 0.5, &q, scratch, cap, needed);
+    if (rc == 0 && (q.allocator != &borrowed_allocator || !q.raw || q.raw < scratch || q.raw >= scratch + cap)) rc = -1;
+    if (rc != 0 && (q.raw || q.amount || q.allocator)) rc = -100;
+    return rc;
+}
+
+static int verify_into(size_t cap, size_t *needed) {
+    VerifyResponse v;
+    int rc = nlx402_verify_quote_into(&client, &quote, quote.nonce, &v, scratch, cap, needed);
+    if (rc == 0 && !v.ok) rc = -1;
+    return rc;
+}
+
+static int paid_access_into(size_t cap, size_t *needed) {
+    PaidAccessResponse p;
+    int rc = nlx402_get_paid_access_into(&client, TX, quote.nonce, &p, scratch, cap, needed);
+    if (rc == 0 && (p.allocator != &borrowed_allocator || !p.ok)) rc = -1;
+    if (rc != 0 && (p.amount || p.status || p.allocator)) rc = -100;
+    return rc;
+}
+
+static size_t held(void) {
+    Nlx402MemStats st;
+    nlx402_client_mem_stats(&client, &st);
+    return st.total.current;
+}
+
+static void check(const char *name, int (*call)(size_t, size_t *)) {
+    char what[128];
+    size_t needed = 0;
+
+    /* Warm: the first call may still create the handle or intern fields. */
+    snprintf(what, sizeof(what), "%s: call with a large buffer failed", name);
+    expect(call(sizeof(scratch), &needed) == 0 && needed > 0, what);
+    size_t before = held();
+
+    needed = 0;
+    int rc = call(16, &needed);
+    snprintf(what, sizeof(what), "%s: 16-byte buffer gave %d, needed %zu", name, rc, needed);
+    expect(rc == NLX402_ERR_BUFFER_TOO_SMALL && needed > 16, what);
+    snprintf(what, sizeof(what), "%s: a too-small buffer left %zu bytes behind", name, held() - before);
+    expect(held() == before, what);
+
+    /* Each retry gets past the allocation that stopped the last one. */
+    int tries = 0;
+    size_t cap = 0;
+    while (rc == NLX402_ERR_BUFFER_TOO_SMALL && tries++ < 64) {
+        snprintf(what, sizeof(what), "%s: retry with %zu bytes asked for %zu", name, cap, needed);
+        expect(needed > cap && needed <= sizeof(scratch), what);
+        if (needed <= cap || needed > sizeof(scratch)) return;
+        cap = needed;
+        rc = call(cap, &needed);
+    }
+    snprintf(what, sizeof(what), "%s: retries ended in %d after %d tries", name, rc, tries);
+    expect(rc == 0, what);
+    snprintf(what, sizeof(what), "%s: retries moved client memory", name);
+    expect(held() == before, what);
+
+    /* A failure that is not about the buffer empties the response too. */
+    mock.body = "{\"ok\":true,\"amount\":\"1\",\"x402\":{\"amount\":\"1\",\"status\":\"settled\"}";
+    rc = call(sizeof(scratch), &needed);
+    mock.body = NULL;
+    snprintf(what, sizeof(what), "%s: malformed body gave %d", name, rc);
+    expect(rc == -1, what);
+}
+
+int main(void) {
+    if (mock_start(&mock) != 0) {
+        fprintf(stderr, "mock server failed to start\n");
+        return 1;
+    }
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    nlx402_client_init(&client, mock.url, "test-key");
+    expect(nlx402_get_quote(&client, 0.5, &quote) == 0, "reference quote failed");
+
+    check("get_quote_into", quote_into);
+    check("verify_quote_into", verify_into);
+    check("get_paid_access_into", paid_access_into);
+
+    nlx402_free_quote(&quote);
+    nlx402_client_cleanup(&client);
+    curl_global_cleanup();
+    mock_stop(&mock);
+    printf("into: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
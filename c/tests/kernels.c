@@ -0,0 +1,100 @@
+/* Every scanning kernel level the CPU supports must return what the scalar
+ * loop returns, at every length and alignment, with the stopping byte at
+ * every position, and must not read past the end of its input. */
+#include "../nlx402.c"
+#include <stdint.h>
+
+#define PAGE 4096
+
+static int failures;
+static unsigned long long rng = 0x2545f4914f6cdd1dULL;
+
+static unsigned int next_random(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return (unsigned int)(rng >> 32);
+}
+
+/* Bytes either side of every class boundary the kernels test. */
+static const unsigned char edges[] = {
+    0x00, 0x01, 0x1f, 0x20, 0x21, '"', '\\', '-', '.', '/', '0', '9', ':', '@', 'A', 'Z', '[',
+    '_', '`', 'a', 'z', '{', '~', 0x7f, 0x80, 0x9f, 0xa0, 0xc3, 0xdf, 0xe0, 0xfe, 0xff,
+};
+
+static void check(const char *what, const char *s, size_t n, size_t want, size_t got, int level) {
+    if (got != want && failures++ < 20) {
+        fprintf(stderr, "%s at level %s, length %zu, offset %zu: got %zu, want %zu\n", what, cpu_level_names[level],
+                n, (size_t)((uintptr_t)s % 64), got, want);
+    }
+}
+
+static void compare(const char *s, size_t n, int level) {
+    check("json_plain_run", s, n, json_plain_run_scalar(s, n), json_plain_run(s, n), level);
+    check("url_safe_run", s, n, url_safe_run_scalar(s, n), url_safe_run(s, n), level);
+}
+
+int main(void) {
+    /* Inputs end right before a page that cannot be read. */
+    unsigned char *map = mmap(NULL, 2 * PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED || mprotect(map + PAGE, PAGE, PROT_NONE) != 0) {
+        fprintf(stderr, "could not map a guard page\n");
+        return 1;
+    }
+    unsigned char *guard = map + PAGE;
+    int top = nlx402_cpu_level();
+    unsigned long long cases = 0;
+
+    for (int level = NLX402_CPU_SCALAR; level <= top; level++) {
+        if (nlx402_set_cpu_level(level) != 0) {
+            fprintf(stderr, "level %s was reported but cannot be selected\n", cpu_level_names[level]);
+            return 1;
+        }
+
+        /* One stopping byte at each position of an otherwise plain run,
+         * for each boundary byte and every length up to past two
+         * AVX-512 blocks. */
+        for (size_t n = 0; n <= 160; n++) {
+            unsigned char *s = guard - n;
+            for (size_t e = 0; e < sizeof(edges); e++) {
+                for (size_t pos = 0; pos <= n; pos++) {
+                    memset(s, 'a', n);
+                    if (pos < n) s[pos] = edges[e];
+                    compare((const char *)s, n, level);
+                    cases++;
+                }
+            }
+        }
+
+        /* Random mixes of plain and boundary bytes at every alignment. */
+        for (int round = 0; round < 20000; round++) {
+            size_t n = next_random() % 300;
+            size_t align = next_random() % 64;
+            unsigned char *s = guard - n - align;
+            unsigned int stop_odds = 1 + next_random() % 200;
+            for (size_t i = 0; i < n; i++) {
+                s[i] = next_random() % stop_odds == 0 ? edges[next_random() % sizeof(edges)]
+                                                      : (unsigned char)("abcXYZ019-._~"[next_random() % 13]);
+            }
+            compare((const char *)s, n, level);
+            /* The same bytes run up to the guard page. */
+            memmove(guard - n, s, n);
+            compare((const char *)(guard - n), n, level);
+            cases += 2;
+        }
+
+        /* Fully random bytes. */
+        for (int round = 0; round < 20000; round++) {
+            size_t n = next_random() % 200;
+            unsigned char *s = guard - n;
+            for (size_t i = 0; i < n; i++) s[i] = (unsigned char)next_random();
+            compare((const char *)s, n, level);
+            cases++;
+        }
+        printf("kernels: level %s checked\n", cpu_level_names[level]);
+    }
+
+    munmap(map, 2 * PAGE);
+    printf("kernels: %d levels, %llu cases, %d failures\n", top + 1, cases, failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+/* Lazy responses: escapes and surrogate pairs decode in place on first
+ * access, bad escapes fail only the value that holds them, malformed or
+ * truncated bodies are refused whole, and the accessors stay inside their
+ * entries. The mock answers every request with a fixed body. */
+#include "../nlx402.c"
+#include "mock.h"
+
+#define TX "5VERv8NMvzbJMEkV8xnrLkEaWRtSz9CosKDYjCJjBRnbJLgp8uirBgmQpjKhoR4tjF3ZpRzrFmBV6UjKdiSZkQUW"
+
+static const char good[] =
+    "{\"esc\":\"q\\\"b\\\\s\\/c\\b\\f\\n\\r\\t\",\"bmp\":\"\\u00e9\\u20AC\",\"pair\":\"a\\ud83d\\ude00b\","
+    "\"plain\":\"mainnet\",\"list\":[\"one\",\"t\\u0077o\",\"three\"],\"nums\":[1,2],\"empty\":[],"
+    "\"n\":-12.5e1,\"t\":true,\"f\":false,\"z\":null,\"obj\":{\"k\":\"v\",\"deep\":{\"x\":\"y\"}},"
+    "\"lone_high\":\"\\ud83d\",\"lone_low\":\"\\ude00\",\"high_then_a\":\"\\ud83d\\u0041\","
+    "\"bad_escape\":\"\\x\",\"bad_hex\":\"\\u12g4\",\"short_hex\":\"\\u12\"}";
+
+static int failures;
+static MockServer mock;
+static Nlx402Client client;
+
+static void expect(int ok, const char *what) {
+    if (!ok) {
+        fprintf(stderr, "%s\n", what);
+        failures++;
+    }
+}
+
+static int view_is(Nlx402LazyResponse *r, const char *path, const char *want, size_t len) {
+    Nlx402View v;
+    return nlx402_lazy_string(r, path, &v) == 0 && v.len == len && memcmp(v.ptr, want, len) == 0;
+}
+
+static size_t responses_held(void) {
+    Nlx402MemStats st;
+    nlx402_client_mem_stats(&client, &st);
+    return st.by_category[NLX402_MEM_RESPONSES].current;
+}
+
+static int get(const char *body, Nlx402LazyResponse *r) {
+    mock.body = body;
+    return nlx402_get_metadata_lazy(&client, r);
+}
+
+static void check_values(void) {
+    Nlx402LazyResponse r;
+    Nlx402View v;
+    int b;
+    double d;
+    expect(get(good, &r) == 0, "well-formed body refused");
+
+    /* Every simple escape, twice: the second read sees the decoded text. */
+    for (int pass = 0; pass < 2; pass++) {
+        expect(view_is(&r, "esc", "q\"b\\s/c\b\f\n\r\t", 12), "simple escapes");
+    }
+    expect(view_is(&r, "bmp", "\xc3\xa9\xe2\x82\xac", 5), "\\u escapes below U+FFFF");
+    expect(view_is(&r, "pair", "a\xf0\x9f\x98\x80" "b", 6), "surrogate pair");
+    expect(view_is(&r, "plain", "mainnet", 7), "unescaped string");
+    expect(view_is(&r, "OBJ.K", "v", 1) && view_is(&r, "obj.deep.x", "y", 1), "nested or case-insensitive path");
+
+    /* Bad escapes fail their own value and leave the rest readable. */
+    static const char *const bad[] = { "lone_high", "lone_low", "high_then_a", "bad_escape", "bad_hex", "short_hex" };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        if (nlx402_lazy_string(&r, bad[i], &v) == 0) {
+            fprintf(stderr, "%s decoded\n", bad[i]);
+            failures++;
+        }
+    }
+    expect(view_is(&r, "plain", "mainnet", 7), "a bad escape disturbed another value");
+
+    /* string_at stays inside the array and only returns strings. */
+    expect(nlx402_lazy_count(&r, "list") == 3 && nlx402_lazy_count(&r, "empty") == 0 &&
+           nlx402_lazy_count(&r, "obj") == 2, "counts");
+    expect(nlx402_lazy_string_at(&r, "list", 1, &v) == 0 && v.len == 3 && memcmp(v.ptr, "two", 3) == 0, "list[1]");
+    expect(nlx402_lazy_string_at(&r, "list", 2, &v) == 0 && v.len == 5 && memcmp(v.ptr, "three", 5) == 0, "list[2]");
+    expect(nlx402_lazy_string_at(&r, "list", 3, &v) != 0 && nlx402_lazy_string_at(&r, "list", -1, &v) != 0 &&
+           nlx402_lazy_string_at(&r, "empty", 0, &v) != 0, "string_at out of bounds");
+    expect(nlx402_lazy_string_at(&r, "nums", 0, &v) != 0 && nlx402_lazy_string_at(&r, "obj", 0, &v) != 0 &&
+           nlx402_lazy_string_at(&r, "plain", 0, &v) != 0 && nlx402_lazy_string_at(&r, "missing", 0, &v) != 0,
+           "string_at on a number, an object, a string or nothing");
+
+    /* Other types, and the wrong accessor for each. */
+    expect(nlx402_lazy_number(&r, "n", &d) == 0 && d == -125.0, "number");
+    expect(nlx402_lazy_bool(&r, "t", &b) == 0 && b == 1 && nlx402_lazy_bool(&r, "f", &b) == 0 && b == 0, "bools");
+    expect(nlx402_lazy_bool(&r, "z", &b) != 0 && nlx402_lazy_number(&r, "plain", &d) != 0 &&
+           nlx402_lazy_string(&r, "n", &v) != 0 && nlx402_lazy_count(&r, "plain") != 0 &&
+           nlx402_lazy_string(&r, "obj", &v) != 0, "accessor of the wrong type");
+    expect(nlx402_lazy_string(&r, "plain.x", &v) != 0 && nlx402_lazy_string(&r, "obj.", &v) != 0 &&
+           nlx402_lazy_string(&r, "", &v) != 0, "path past a leaf");
+
+    nlx402_free_lazy(&r);
+    expect(responses_held() == 0 && !r.body && !r.entries, "free left response memory");
+}
+
+static void check_refused(void) {
+    static const char *const malformed[] = {
+        "", "   ", "[]x", "{\"a\":1,}", "{\"a\":tru}", "{\"a\":nul}", "{\"a\" 1}", "{\"a\":1}}", "{\"a\":1]",
+        "[1,2}", "{1:2}", "{\"a\":\"x\ny\"}", "{\"a\":1} {}", "{\"a\":'x'}", "{,}",
+    };
+    Nlx402LazyResponse r;
+    for (size_t i = 0; i < sizeof(malformed) / sizeof(malformed[0]); i++) {
+        if (get(malformed[i], &r) == 0) {
+            fprintf(stderr, "malformed body %zu accepted\n", i);
+            failures++;
+            nlx402_free_lazy(&r);
+        } else if (r.body || r.entries || responses_held() != 0) {
+            fprintf(stderr, "malformed body %zu left memory behind\n", i);
+            failures++;
+        }
+    }
+
+    /* Every proper prefix of the well-formed body is incomplete. */
+    static char prefix[sizeof(good)];
+    int accepted = 0;
+    for (size_t n = 0; n + 1 < sizeof(good); n++) {
+        memcpy(prefix, good, n);
+        prefix[n] = '\0';
+        if (get(prefix, &r) == 0) {
+            accepted++;
+            nlx402_free_lazy(&r);
+        }
+    }
+    expect(accepted == 0, "a truncated body was accepted");
+    expect(responses_held() == 0, "truncated bodies left memory behind");
+}
+
+int main(void) {
+    if (mock_start(&mock) != 0) {
+        fprintf(stderr, "mock server failed to start\n");
+        return 1;
+    }
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    nlx402_client_init(&client, mock.url, "test-key");
+
+    check_values();
+    check_refused();
+
+    /* And a real paid-access body from the mock's own fixture. */
+    mock.body = NULL;
+    Nlx402LazyResponse paid;
+    int ok = 0;
+    expect(nlx402_get_paid_access_lazy(&client, TX, "3f1c9a7e5b2d4c6a8e0f1b3d5c7a9e2f", &paid) == 0, "paid access failed");
+    expect(nlx402_lazy_bool(&paid, "ok", &ok) == 0 && ok && view_is(&paid, "x402.status", "settled", 7) &&
+           view_is(&paid, "x402.tx", TX, strlen(TX)), "paid access fields");
+    nlx402_free_lazy(&paid);
+
+    nlx402_client_cleanup(&client);
+    curl_global_cleanup();
+    mock_stop(&mock);
+    printf("lazy: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
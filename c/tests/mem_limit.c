@@ -0,0 +1,153 @@
+/* A client's memory limit makes allocations past it fail, and can be moved
+ * while other threads are making requests on the same client (run under
+ * -fsanitize=thread to check the limit is read and written atomically).
+ * Threads racing for the last bytes under a limit never take the client
+ * past it, through either malloc or realloc growth.
+ * Raw bodies from nlx402_request are the caller's, from plain malloc. */
+#include "../nlx402.c"
+#include "mock.h"
+
+#define THREADS 4
+#define REQUESTS 50
+#define GRAB_ROUNDS 2000
+#define GRAB_BLOCKS 8
+#define GRAB_SIZE 4096
+
+static int failures;
+static Nlx402Client client;
+static atomic_int done;
+static atomic_int errors;
+static pthread_barrier_t start;
+
+/* Takes blocks until the limit refuses one, half grown by realloc from a
+ * small start, then lets them all go. */
+static void *grab(void *arg) {
+    (void)arg;
+    pthread_barrier_wait(&start);
+    for (int round = 0; round < GRAB_ROUNDS; round++) {
+        void *held[GRAB_BLOCKS];
+        int n = 0;
+        while (n < GRAB_BLOCKS) {
+            void *p;
+            if (n % 2) {
+                p = mem_alloc(&client.allocator, NLX402_MEM_FLOWS, 64);
+                void *grown = p ? mem_realloc(&client.allocator, NLX402_MEM_FLOWS, p, GRAB_SIZE) : NULL;
+                if (p && !grown) mem_free(&client.allocator, p);
+                p = grown;
+            } else {
+                p = mem_alloc(&client.allocator, NLX402_MEM_FLOWS, GRAB_SIZE);
+            }
+            if (!p) break;
+            held[n++] = p;
+        }
+        while (n > 0) mem_free(&client.allocator, held[--n]);
+    }
+    return NULL;
+}
+
+static void *requests(void *arg) {
+    (void)arg;
+    for (int i = 0; i < REQUESTS; i++) {
+        MetadataResponse m;
+        if (nlx402_get_metadata(&client, &m) != 0) atomic_fetch_add(&errors, 1);
+        else nlx402_free_metadata(&m);
+    }
+    atomic_fetch_add(&done, 1);
+    return NULL;
+}
+
+int main(void) {
+    MockServer mock = { 0 };
+    if (mock_start(&mock) != 0) {
+        fprintf(stderr, "mock server failed to start\n");
+        return 1;
+    }
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    nlx402_client_init(&client, mock.url, "test-key");
+
+    MetadataResponse m;
+    Nlx402MemStats before, after;
+    nlx402_client_mem_stats(&client, &before);
+    nlx402_client_set_mem_limit(&client, before.total.current + 1);
+    if (nlx402_get_metadata(&client, &m) == 0) {
+        fprintf(stderr, "request succeeded past the memory limit\n");
+        nlx402_free_metadata(&m);
+        failures++;
+    }
+    nlx402_client_mem_stats(&client, &after);
+    if (after.by_category[NLX402_MEM_RESPONSES].current != 0) {
+        fprintf(stderr, "a refused request left response memory behind\n");
+        failures++;
+    }
+    nlx402_client_set_mem_limit(&client, 0);
+    if (nlx402_get_metadata(&client, &m) != 0) {
+        fprintf(stderr, "request failed after the limit was lifted\n");
+        failures++;
+    } else {
+        nlx402_free_metadata(&m);
+    }
+
+    /* A raw body is not client memory, and either free releases it. */
+    for (int k = 0; k < 2; k++) {
+        MemoryChunk chunk;
+        long status = 0;
+        if (nlx402_request(&client, "/api/metadata", "GET", 0, NULL, NULL, &status, &chunk) != 0 || status != 200) {
+            fprintf(stderr, "raw request failed\n");
+            failures++;
+            continue;
+        }
+        nlx402_client_mem_stats(&client, &after);
+        if (after.by_category[NLX402_MEM_RESPONSES].current != 0 || chunk.data[chunk.size] != '\0') {
+            fprintf(stderr, "a raw body was counted or not terminated\n");
+            failures++;
+        }
+        if (k == 0) {
+            free(chunk.data);
+        } else {
+            nlx402_free_chunk(&chunk);
+            if (chunk.data) {
+                fprintf(stderr, "nlx402_free_chunk left the body set\n");
+                failures++;
+            }
+        }
+    }
+
+    /* Move a generous limit up and down while other threads allocate. */
+    pthread_t threads[THREADS];
+    atomic_init(&done, 0);
+    atomic_init(&errors, 0);
+    for (int i = 0; i < THREADS; i++) pthread_create(&threads[i], NULL, requests, NULL);
+    for (size_t k = 0; atomic_load(&done) < THREADS; k++) {
+        nlx402_client_set_mem_limit(&client, k % 2 ? 0 : (size_t)64 * 1024 * 1024);
+    }
+    for (int i = 0; i < THREADS; i++) pthread_join(threads[i], NULL);
+    if (atomic_load(&errors) != 0) {
+        fprintf(stderr, "%d requests failed under a generous limit\n", atomic_load(&errors));
+        failures++;
+    }
+
+    /* Room for a few blocks between all the threads, and a peak that would
+     * show it if they ever held more. */
+    Nlx402MemStats raced;
+    nlx402_client_mem_stats(&client, &before);
+    size_t limit = before.total.peak + 3 * (GRAB_SIZE + 64);
+    nlx402_client_set_mem_limit(&client, limit);
+    pthread_barrier_init(&start, NULL, THREADS);
+    for (int i = 0; i < THREADS; i++) pthread_create(&threads[i], NULL, grab, NULL);
+    for (int i = 0; i < THREADS; i++) pthread_join(threads[i], NULL);
+    pthread_barrier_destroy(&start);
+    nlx402_client_mem_stats(&client, &raced);
+    if (raced.total.peak > limit || raced.total.current != before.total.current ||
+        raced.by_category[NLX402_MEM_FLOWS].current != before.by_category[NLX402_MEM_FLOWS].current) {
+        fprintf(stderr, "racing threads reached %zu bytes under a limit of %zu, %zu still held\n",
+                raced.total.peak, limit, raced.total.current - before.total.current);
+        failures++;
+    }
+    nlx402_client_set_mem_limit(&client, 0);
+
+    nlx402_client_cleanup(&client);
+    curl_global_cleanup();
+    mock_stop(&mock);
+    printf("mem_limit: %d threads x %d requests, %d failures\n", THREADS, REQUESTS, failures);
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,296 @@
+#define _GNU_SOURCE
+#include "mock.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#define MOCK_BUF 65536
+
+size_t mock_fixture(int which, const char *a, const char *b, char *out, size_t cap) {
+    int n = -1;
+    switch (which) {
+    case MOCK_METADATA:
+        n = snprintf(out, cap,
+                     "{\"ok\":true,\"metadata\":{\"network\":\"mainnet-beta\",\"version\":\"1\","
+                     "\"supported_chains\":[\"solana\",\"base\"]},"
+                     "\"supported_mints\":[\"" MOCK_MINT "\",\"Es9vMFrzaCERmJfrF4H2FYD4KCoNkY11McCe8BenwNYB\"]}");
+        break;
+    case MOCK_AUTH_ME:
+        n = snprintf(out, cap,
+                     "{\"ok\":true,\"created_at\":1700000000.5,\"wallet_id\":\"wal_123\","
+                     "\"selected_mint\":\"" MOCK_MINT "\"}");
+        break;
+    case MOCK_QUOTE:
+        n = snprintf(out, cap,
+                     "{\"amount\":\"%s\",\"chain\":\"solana\",\"decimals\":6,\"expires_at\":1760000000,"
+                     "\"mint\":\"" MOCK_MINT "\",\"network\":\"mainnet-beta\",\"nonce\":\"%s\","
+                     "\"recipient\":\"" MOCK_RECIPIENT "\",\"version\":\"1\"}",
+                     a ? a : "0.5", b ? b : "3f1c9a7e5b2d4c6a8e0f1b3d5c7a9e2f");
+        break;
+    case MOCK_VERIFY:
+        n = snprintf(out, cap, "{\"ok\":%s}", a ? a : "true");
+        break;
+    case MOCK_PAID_ACCESS:
+        n = snprintf(out, cap,
+                     "{\"ok\":true,\"x402\":{\"amount\":\"500000\",\"decimals\":6,\"mint\":\"" MOCK_MINT "\","
+                     "\"nonce\":\"%s\",\"status\":\"settled\",\"tx\":\"%s\",\"version\":\"1\"}}",
+                     b ? b : "", a ? a : "");
+        break;
+    }
+    return n < 0 || (size_t)n >= cap ? 0 : (size_t)n;
+}
+
+/* Copies header name's value out of the request head; 0 if it is absent. */
+static int mock_header(const char *head, const char *name, char *out, size_t cap) {
+    size_t n = strlen(name);
+    for (const char *line = strstr(head, "\r\n"); line && line[2]; line = strstr(line + 2, "\r\n")) {
+        const char *l = line + 2;
+        if (strncasecmp(l, name, n) != 0 || l[n] != ':') continue;
+        l += n + 1;
+        while (*l == ' ') l++;
+        size_t v = strcspn(l, "\r");
+        if (v >= cap) v = cap - 1;
+        memcpy(out, l, v);
+        out[v] = '\0';
+        return 1;
+    }
+    return 0;
+}
+
+/* "key":"value" out of a flat JSON object; enough for x-payment. */
+static int mock_json_string(const char *json, const char *key, char *out, size_t cap) {
+    char pattern[64];
+    snprintf(pattern, sizeof(pattern), "\"%s\":\"", key);
+    const char *v = strstr(json, pattern);
+    if (!v) return 0;
+    v += strlen(pattern);
+    size_t n = strcspn(v, "\"");
+    if (n >= cap) n = cap - 1;
+    memcpy(out, v, n);
+    out[n] = '\0';
+    return 1;
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/* The decoded value of a form field. */
+static int mock_form(const char *body, const char *name, char *out, size_t cap) {
+    size_t n = strlen(name);
+    for (const char *f = body; f && *f; f = strchr(f, '&') ? strchr(f, '&') + 1 : NULL) {
+        if (strncmp(f, name, n) != 0 || f[n] != '=') continue;
+        size_t len = 0;
+        for (f += n + 1; *f && *f != '&' && len + 1 < cap; f++) {
+            if (*f == '%' && hex_digit(f[1]) >= 0 && hex_digit(f[2]) >= 0) {
+                out[len++] = (char)(hex_digit(f[1]) * 16 + hex_digit(f[2]));
+                f += 2;
+            } else {
+                out[len++] = *f == '+' ? ' ' : *f;
+            }
+        }
+        out[len] = '\0';
+        return 1;
+    }
+    return 0;
+}
+
+static int mock_send(int fd, const void *p, size_t n) {
+    const char *b = (const char *)p;
+    while (n > 0) {
+        ssize_t w = send(fd, b, n, MSG_NOSIGNAL);
+        if (w <= 0) return -1;
+        b += w;
+        n -= (size_t)w;
+    }
+    return 0;
+}
+
+static int mock_respond(MockServer *m, int fd, int status, const char *body) {
+    size_t len = strlen(body);
+    char head[256];
+    int n = snprintf(head, sizeof(head), "HTTP/1.1 %d %s\r\nContent-Type: application/json\r\n", status,
+                     status == 200 ? "OK" : "Error");
+    if (m->chunk) n += snprintf(head + n, sizeof(head) - (size_t)n, "Transfer-Encoding: chunked\r\n\r\n");
+    else n += snprintf(head + n, sizeof(head) - (size_t)n, "Content-Length: %zu\r\n\r\n", len);
+    int rc = mock_send(fd, head, (size_t)n);
+
+    if (rc == 0 && !m->chunk) rc = mock_send(fd, body, len);
+    for (size_t at = 0; rc == 0 && m->chunk && at < len; at += m->chunk) {
+        size_t part = len - at < m->chunk ? len - at : m->chunk;
+        char size[32];
+        int s = snprintf(size, sizeof(size), "%zx\r\n", part);
+        rc = mock_send(fd, size, (size_t)s);
+        if (rc == 0) rc = mock_send(fd, body + at, part);
+        if (rc == 0) rc = mock_send(fd, "\r\n", 2);
+        if (rc == 0) atomic_fetch_add(&m->chunks, 1);
+        if (rc == 0 && m->pause_us) usleep(m->pause_us);
+    }
+    if (rc == 0 && m->chunk) rc = mock_send(fd, "0\r\n\r\n", 5);
+    return rc;
+}
+
+static int mock_route(MockServer *m, int fd, const char *head, const char *body) {
+    char path[256], key[256], value[1024], json[4096];
+    sscanf(head, "%*s %255s", path);
+    int is_post = strncmp(head, "POST ", 5) == 0;
+    atomic_fetch_add(&m->requests, 1);
+
+    if (m->body) return mock_respond(m, fd, 200, m->body);
+    if (strcmp(path, "/api/metadata") == 0) {
+        mock_fixture(MOCK_METADATA, NULL, NULL, json, sizeof(json));
+        return mock_respond(m, fd, 200, json);
+    }
+    if (!is_post && !mock_header(head, "x-api-key", key, sizeof(key))) {
+        return mock_respond(m, fd, 401, "{\"ok\":false}");
+    }
+    if (strcmp(path, "/api/auth/me") == 0) {
+        mock_fixture(MOCK_AUTH_ME, NULL, NULL, json, sizeof(json));
+        return mock_respond(m, fd, 200, json);
+    }
+    if (strcmp(path, "/protected") == 0 && mock_header(head, "x-payment", value, sizeof(value))) {
+        char tx[128] = "", payment_nonce[128] = "";
+        mock_json_string(value, "tx", tx, sizeof(tx));
+        mock_json_string(value, "nonce", payment_nonce, sizeof(payment_nonce));
+        mock_fixture(MOCK_PAID_ACCESS, tx, payment_nonce, json, sizeof(json));
+        return mock_respond(m, fd, 200, json);
+    }
+    if (strcmp(path, "/protected") == 0) {
+        char price[64] = "0.5", quote_nonce[33];
+        mock_header(head, "x-total-price", price, sizeof(price));
+        snprintf(quote_nonce, sizeof(quote_nonce), "%032x", (unsigned int)atomic_load(&m->requests));
+        mock_fixture(MOCK_QUOTE, price, quote_nonce, json, sizeof(json));
+        return mock_respond(m, fd, 200, json);
+    }
+    if (strcmp(path, "/verify") == 0 && is_post) {
+        char *form = (char *)malloc(MOCK_BUF), nonce[256];
+        int ok = 0;
+        if (form && mock_form(body, "payment_data", form, MOCK_BUF) && mock_form(body, "nonce", nonce, sizeof(nonce))) {
+            char want[300];
+            snprintf(want, sizeof(want), "\"nonce\":\"%s\"", nonce);
+            ok = strstr(form, want) != NULL;
+        }
+        free(form);
+        mock_fixture(MOCK_VERIFY, ok ? "true" : "false", NULL, json, sizeof(json));
+        return mock_respond(m, fd, 200, json);
+    }
+    return mock_respond(m, fd, 404, "{\"ok\":false}");
+}
+
+typedef struct {
+    MockServer *m;
+    int fd;
+} MockConn;
+
+static void *mock_conn(void *arg) {
+    MockConn c = *(MockConn *)arg;
+    free(arg);
+    char *buf = (char *)malloc(MOCK_BUF + 1);
+    size_t have = 0;
+    while (buf) {
+        char *end;
+        buf[have] = '\0';
+        while (!(end = strstr(buf, "\r\n\r\n"))) {
+            if (have == MOCK_BUF) goto done;
+            ssize_t n = recv(c.fd, buf + have, MOCK_BUF - have, 0);
+            if (n <= 0) goto done;
+            have += (size_t)n;
+            buf[have] = '\0';
+        }
+        size_t head_len = (size_t)(end - buf) + 4;
+        char value[64];
+        size_t body_len = mock_header(buf, "Content-Length", value, sizeof(value)) ? strtoul(value, NULL, 10) : 0;
+        if (body_len > MOCK_BUF - head_len) goto done;
+        if (mock_header(buf, "Expect", value, sizeof(value)) && mock_send(c.fd, "HTTP/1.1 100 Continue\r\n\r\n", 25) != 0)
+            goto done;
+        while (have < head_len + body_len) {
+            ssize_t n = recv(c.fd, buf + have, MOCK_BUF - have, 0);
+            if (n <= 0) goto done;
+            have += (size_t)n;
+        }
+
+        char saved = buf[head_len + body_len];
+        buf[head_len + body_len] = '\0';
+        end[2] = '\0';
+        int rc = mock_route(c.m, c.fd, buf, buf + head_len);
+        buf[head_len + body_len] = saved;
+        if (rc != 0) goto done;
+        memmove(buf, buf + head_len + body_len, have - head_len - body_len);
+        have -= head_len + body_len;
+    }
+done:
+    free(buf);
+    close(c.fd);
+    return NULL;
+}
+
+static void *mock_accept(void *arg) {
+    MockServer *m = (MockServer *)arg;
+    for (;;) {
+        int fd = accept(m->fd, NULL, NULL);
+        if (fd < 0) {
+            if (atomic_load(&m->stopping)) return NULL;
+            continue;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        MockConn *c = (MockConn *)malloc(sizeof(*c));
+        pthread_t t;
+        if (!c) {
+            close(fd);
+            continue;
+        }
+        c->m = m;
+        c->fd = fd;
+        if (pthread_create(&t, NULL, mock_conn, c) != 0) {
+            free(c);
+            close(fd);
+            continue;
+        }
+        pthread_detach(t);
+    }
+}
+
+int mock_start(MockServer *m) {
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    atomic_init(&m->requests, 0);
+    atomic_init(&m->chunks, 0);
+    atomic_init(&m->stopping, 0);
+    m->fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (m->fd < 0) return -1;
+    if (bind(m->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(m->fd, 64) != 0 ||
+        getsockname(m->fd, (struct sockaddr *)&addr, &addr_len) != 0) {
+        close(m->fd);
+        return -1;
+    }
+    m->port = ntohs(addr.sin_port);
+    snprintf(m->url, sizeof(m->url), "http://127.0.0.1:%d", m->port);
+    if (pthread_create(&m->thread, NULL, mock_accept, m) != 0) {
+        close(m->fd);
+        return -1;
+    }
+    return 0;
+}
+
+/* Stops accepting; connections still open end when their client closes. */
+void mock_stop(MockServer *m) {
+    atomic_store(&m->stopping, 1);
+    shutdown(m->fd, SHUT_RDWR);
+    close(m->fd);
+    pthread_join(m->thread, NULL);
+}
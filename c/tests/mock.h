@@ -0,0 +1,42 @@
+/* In-process stand-in for the NLx402 API, used by the tests and benchmarks.
+ * Every response is rendered from one JSON fixture. */
+#ifndef NLX402_MOCK_H
+#define NLX402_MOCK_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+enum {
+    MOCK_METADATA,
+    MOCK_AUTH_ME,
+    MOCK_QUOTE,
+    MOCK_VERIFY,
+    MOCK_PAID_ACCESS
+};
+
+typedef struct {
+    int fd;
+    int port;
+    char url[64];
+    size_t chunk;           /* > 0: chunked transfer in pieces of this size */
+    unsigned pause_us;      /* sleep after each chunk */
+    const char *body;       /* non-NULL: every request is answered 200 with this */
+    atomic_int requests;
+    atomic_int chunks;      /* body chunks sent */
+    atomic_int stopping;
+    pthread_t thread;
+} MockServer;
+
+/* Listens on a free loopback port; m->url is the client's base URL. */
+int mock_start(MockServer *m);
+void mock_stop(MockServer *m);
+
+#define MOCK_MINT "EPjFWdd5AufqSSqeM2qN1xzybapC8G4wEGGkZwyTDt1v"
+#define MOCK_RECIPIENT "9WzDXwBbmkg8ZTbNMqUxvQRAyrZzDsGYdLVL9zYtAWWM"
+
+/* The JSON body for a route. MOCK_QUOTE takes the amount and nonce,
+ * MOCK_PAID_ACCESS the tx and nonce, MOCK_VERIFY "true" or "false". */
+size_t mock_fixture(int which, const char *a, const char *b, char *out, size_t cap);
+
+#endif
@@ -0,0 +1,160 @@
+/* Number reading and writing against the C library: json_number must give
+ * the bits strtod gives, json_format_number must read back to the same
+ * double, and num_format_price must print what %.8f prints. Sweeps every
+ * value on the grids responses and prices use, then random inputs. */
+#include "../nlx402.c"
+#include <float.h>
+#include <math.h>
+
+static int failures;
+static unsigned long long rng = 0x9e3779b97f4a7c15ULL;
+
+static unsigned long long next_random(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 7;
+    rng ^= rng << 17;
+    return rng;
+}
+
+static void fail(const char *what, const char *text, double got, double want) {
+    if (failures++ < 20) fprintf(stderr, "%s \"%s\": got %.17g, want %.17g\n", what, text, got, want);
+}
+
+static void check_parse(const char *text) {
+    size_t len = strlen(text);
+    double got;
+    double want = strtod(text, NULL);
+    if (json_number(text, len, &got) != 0) {
+        fail("rejected", text, 0, want);
+        return;
+    }
+    if (memcmp(&got, &want, sizeof(got)) != 0) fail("parse", text, got, want);
+}
+
+static void check_format(double v) {
+    char text[64];
+    double back;
+    int n = json_format_number(v, text, sizeof(text));
+    if (n <= 0 || (size_t)n >= sizeof(text) || text[n] != '\0') {
+        fail("format", "", 0, v);
+        return;
+    }
+    if (json_number(text, (size_t)n, &back) != 0 || back != v || strtod(text, NULL) != v) fail("format", text, back, v);
+}
+
+static void check_price(double v) {
+    char got[64];
+    char want[64];
+    size_t n = num_format_price(v, got, sizeof(got));
+    snprintf(want, sizeof(want), "%.8f", v);
+    if (n == 0 || strcmp(got, want) != 0) {
+        if (failures++ < 20) fprintf(stderr, "price %.17g: got \"%s\", want \"%s\"\n", v, n ? got : "", want);
+    }
+}
+
+int main(void) {
+    char text[64];
+    unsigned long long counts[3] = { 0, 0, 0 };
+
+    /* Every integer below 500000, and as many amounts with 6 and with 8
+     * fraction digits, as responses carry them. */
+    for (unsigned long long i = 0; i < 500000; i++) {
+        snprintf(text, sizeof(text), "%llu", i);
+        check_parse(text);
+        snprintf(text, sizeof(text), "%llu.%06llu", i / 1000, i % 1000 * 997 % 1000000);
+        check_parse(text);
+        snprintf(text, sizeof(text), "0.%08llu", i * 97 % 100000000);
+        check_parse(text);
+        counts[0] += 3;
+    }
+
+    /* Exponents and mantissas at the edges of the exact fast path. */
+    static const char *edges[] = {
+        "0", "-0", "0.0", "-0.0", "0e0", "0e-400", "1e22", "1e23", "-1e22", "1e-22", "1e-23",
+        "9007199254740991", "9007199254740992", "9007199254740993", "90071992547409910", "9007199254740991e22",
+        "9007199254740993e-22", "123456789012345678901234567890", "0.1", "0.2", "0.3", "1.7976931348623157e308",
+        "1.7976931348623159e308", "2.2250738585072014e-308", "4.9406564584124654e-324", "2.4703282292062327e-324",
+        "1e-400", "1e400", "-1e400", "1234e25", "1234E+25", "1234e-25", "0.000000000000000000000000001",
+        "100000000000000000000000", "7.2057594037927933e16", "5e-324", "1.5", "-1.5e+3", "0.5", "1e0",
+    };
+    for (size_t i = 0; i < sizeof(edges) / sizeof(edges[0]); i++) check_parse(edges[i]);
+    for (int e = -330; e <= 330; e++) {
+        for (int m = 1; m <= 9; m++) {
+            snprintf(text, sizeof(text), "%de%d", m, e);
+            check_parse(text);
+            snprintf(text, sizeof(text), "%d.%de%d", m, 9 - m, e);
+            check_parse(text);
+            counts[0] += 2;
+        }
+    }
+
+    /* Random digit strings of every length, with and without exponents. */
+    for (int i = 0; i < 1000000; i++) {
+        unsigned long long r = next_random();
+        int digits = 1 + (int)(r % 25);
+        int point = (int)((r >> 8) % (unsigned long long)(digits + 1));
+        size_t n = 0;
+        if (r >> 63) text[n++] = '-';
+        for (int d = 0; d < digits; d++) {
+            if (d == point && d > 0) text[n++] = '.';
+            unsigned long long q = next_random();
+            text[n++] = (char)('0' + q % 10);
+        }
+        if ((r >> 20) & 1) n += (size_t)snprintf(text + n, sizeof(text) - n, "e%d", (int)((r >> 24) % 80) - 40);
+        text[n] = '\0';
+        check_parse(text);
+        counts[0]++;
+    }
+
+    /* Formatting: every cent and millionth amount, then random bit patterns
+     * and random decimals across the whole range. */
+    for (unsigned long long i = 0; i < 500000; i++) {
+        check_format((double)i / 100.0);
+        check_format((double)i / 1e6);
+        check_format(-(double)i);
+        counts[1] += 3;
+    }
+    for (int i = 0; i < 500000; i++) {
+        unsigned long long bits = next_random();
+        double v;
+        memcpy(&v, &bits, sizeof(v));
+        if (v == v && v - v == 0) check_format(v);
+        check_format((double)(next_random() % 100000000000ULL) / num_pow10[next_random() % 12]);
+        counts[1] += 2;
+    }
+    check_format(0.0);
+    check_format(-0.0);
+    check_format(DBL_MAX);
+    check_format(DBL_MIN);
+    check_format(4.9406564584124654e-324);
+    check_format(9007199254740991.0);
+    check_format(9007199254740992.0);
+    check_format(1e-7);
+    check_format(nextafter(1e-7, 0));
+
+    /* Prices: every multiple of 1e-8 below 0.03, every cent below 10000,
+     * and the doubles either side of each half-way point. */
+    for (unsigned long long k = 1; k < 3000000; k++) {
+        check_price((double)k / 1e8);
+        counts[2]++;
+    }
+    for (unsigned long long k = 1; k < 1000000; k++) {
+        check_price((double)k / 100.0);
+        counts[2]++;
+    }
+    for (int i = 0; i < 250000; i++) {
+        double half = ((double)(next_random() % 10000000000ULL) + 0.5) / 1e8;
+        check_price(half);
+        check_price(nextafter(half, 0));
+        check_price(nextafter(half, 1e9));
+        double any;
+        unsigned long long bits = next_random() >> 2;
+        memcpy(&any, &bits, sizeof(any));
+        if (any > 0 && any < 1e12) check_price(any);
+        counts[2] += 4;
+    }
+
+    printf("numbers: %llu parses, %llu formats, %llu prices, %d failures\n", counts[0], counts[1], counts[2],
+           failures);
+    return failures == 0 ? 0 : 1;
+}
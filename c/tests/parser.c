@@ -0,0 +1,220 @@
+/* The built-in response reader: malformed documents fail however they are
+ * split, escapes split across chunks decode the same as whole ones, strings
+ * longer than the inline buffer move into the handle's receive buffer, and
+ * member names match case-insensitively with the first occurrence winning. */
+#include "../nlx402.c"
+
+static int failures;
+static char events[80000];
+
+/* Member "a" at the root and "b" inside it are kept; everything else is
+ * skipped. Each value is logged so that two parses can be compared. */
+static int log_key(void *ctx, int parent, const char *k, size_t len) {
+    (void)ctx;
+    if (parent == JSON_ROOT && len == 1 && k[0] == 'a') return 2;
+    if (parent == 2 && len == 1 && k[0] == 'b') return 3;
+    return JSON_SKIP;
+}
+
+static int log_value(void *ctx, int slot, int index, int type, const char *s, size_t len) {
+    (void)ctx;
+    if (slot == JSON_ROOT) return 0;
+    size_t n = strlen(events);
+    snprintf(events + n, sizeof(events) - n, "[%d %d %d %zu:", slot, index, type, len);
+    n = strlen(events);
+    if (s && len < sizeof(events) - n - 2) {
+        memcpy(events + n, s, len);
+        n += len;
+    }
+    events[n++] = ']';
+    events[n] = '\0';
+    return 0;
+}
+
+static const JsonShape log_shape = { log_key, log_value };
+
+/* Parses doc in pieces split at the given offsets (split2 may be 0). */
+static int parse_split(Nlx402Handle *h, const char *doc, size_t len, size_t split1, size_t split2) {
+    JsonParser p;
+    json_init(&p, &log_shape, NULL);
+    p.handle = h;
+    events[0] = '\0';
+    size_t cuts[] = { 0, split1, split2 > split1 ? split2 : split1, len };
+    for (int i = 0; i < 3; i++) {
+        if (json_feed(&p, doc + cuts[i], cuts[i + 1] - cuts[i]) != 0) return -1;
+    }
+    return json_finish(&p);
+}
+
+static void expect_malformed(Nlx402Handle *h, const char *doc) {
+    size_t len = strlen(doc);
+    for (size_t i = 0; i <= len; i++) {
+        if (parse_split(h, doc, len, i, 0) == 0) {
+            fprintf(stderr, "accepted malformed %s split at %zu\n", doc, i);
+            failures++;
+            return;
+        }
+    }
+}
+
+/* Every way of cutting doc into three pieces gives the same events. */
+static void expect_split_invariant(Nlx402Handle *h, const char *doc, const char *want) {
+    size_t len = strlen(doc);
+    char whole[sizeof(events)];
+    if (parse_split(h, doc, len, 0, 0) != 0 || (want && strcmp(events, want) != 0)) {
+        fprintf(stderr, "parse of %.60s: got %.200s\n", doc, events);
+        failures++;
+        return;
+    }
+    strcpy(whole, events);
+    size_t step = len > 200 ? len / 40 + 1 : 1;
+    for (size_t i = 0; i <= len; i += step) {
+        for (size_t j = i; j <= len; j += step) {
+            if (parse_split(h, doc, len, i, j) != 0 || strcmp(events, whole) != 0) {
+                fprintf(stderr, "parse of %.60s split at %zu, %zu differs\n", doc, i, j);
+                failures++;
+                return;
+            }
+        }
+    }
+}
+
+static void test_malformed(Nlx402Handle *h) {
+    static const char *docs[] = {
+        "", " ", "{", "}", "[", "{\"a\"}", "{\"a\":}", "{\"a\":1,}", "[1,]", "{\"a\":1}}",
+        "{\"a\":[1]]", "{\"a\":01}", "{\"a\":1.}", "{\"a\":-}", "{\"a\":1e}", "{\"a\":.5}",
+        "{\"a\":tru}", "{\"a\":nul}", "{\"a\":true}x", "{\"a\":\"x\"} 1", "{a:1}", "{'a':1}",
+        "{\"a\":\"\x01\"}", "{\"a\":\"\\x\"}", "{\"a\":\"\\u12\"}", "{\"a\":\"\\u12g4\"}",
+        "{\"a\":\"\\ud800\"}", "{\"a\":\"\\ud800x\"}", "{\"a\":\"\\ud800\\u0041\"}", "{\"a\":\"\\udc00\"}",
+        "{\"a\":\"unterminated}", "{\"z\":[1,2}", "{\"a\":{\"b\":[}}",
+    };
+    for (size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); i++) expect_malformed(h, docs[i]);
+
+    /* Deeper than the reader's stack. */
+    char deep[2 * JSON_DEPTH_MAX + 8];
+    size_t n = 0;
+    for (int i = 0; i <= JSON_DEPTH_MAX; i++) deep[n++] = '[';
+    for (int i = 0; i <= JSON_DEPTH_MAX; i++) deep[n++] = ']';
+    deep[n] = '\0';
+    if (parse_split(h, deep, n, 0, 0) == 0) {
+        fprintf(stderr, "accepted nesting deeper than %d\n", JSON_DEPTH_MAX);
+        failures++;
+    }
+}
+
+static void test_escapes(Nlx402Handle *h) {
+    expect_split_invariant(h, "{\"a\":\"\\u00e9\\ud83d\\ude00\\n\\t\\\"\\\\\\/\"}",
+                           "[2 -1 0 11:\xc3\xa9\xf0\x9f\x98\x80\n\t\"\\/]");
+    expect_split_invariant(h, "{\"a\":{\"b\":\"x\\u0041y\"},\"z\":\"\\u00e9\"}",
+                           "[2 -1 5 0:][3 -1 0 3:xAy]");
+    expect_split_invariant(h, "{\"z\":[1,{\"a\":2},[3]],\"a\":[1,\"s\",{\"b\":1},[2],true,null]}", NULL);
+    expect_split_invariant(h, " {\"a\" : -1.5e+3 } ", "[2 -1 1 7:-1.5e+3]");
+    expect_split_invariant(h, "{\"\\u0061\":1}", "[2 -1 1 1:1]");
+}
+
+static void test_long_tokens(Nlx402Handle *h) {
+    size_t lens[] = { JSON_TOKEN_INLINE - 1, JSON_TOKEN_INLINE, 1023, 1024, 5000, 70000 };
+    for (size_t k = 0; k < sizeof(lens) / sizeof(lens[0]); k++) {
+        size_t len = lens[k];
+        /* Escapes spread through the value, so the move into recv happens
+         * in the middle of both plain runs and escapes. */
+        char *doc = malloc(len * 2 + 32);
+        char *want = malloc(len + 64);
+        size_t n = (size_t)sprintf(doc, "{\"a\":\"");
+        size_t w = (size_t)sprintf(want, "[2 -1 0 %zu:", len);
+        for (size_t i = 0; i < len; i++) {
+            char c = (char)('a' + i % 26);
+            if (i % 97 == 5) {
+                doc[n++] = '\\';
+                doc[n++] = 'n';
+                c = '\n';
+            } else {
+                doc[n++] = c;
+            }
+            want[w++] = c;
+        }
+        n += (size_t)sprintf(doc + n, "\"}");
+        sprintf(want + w, "]");
+        expect_split_invariant(h, doc, want);
+        if (len >= JSON_TOKEN_INLINE && parse_split(NULL, doc, n, 0, 0) == 0) {
+            fprintf(stderr, "a %zu-byte string parsed without a handle\n", len);
+            failures++;
+        }
+        free(doc);
+        free(want);
+    }
+}
+
+static void test_response_keys(Nlx402Client *client) {
+    static const char doc[] =
+        "{\"OK\":true,\"x402\":{\"Amount\":\"1\",\"amount\":\"2\",\"DECIMALS\":6,\"decimals\":7,"
+        "\"nonce\":\"first\",\"nonce\":\"second\",\"Status\":\"settled\",\"status\":\"x\"},"
+        "\"ok\":false,\"X402\":{\"tx\":\"late\"}}";
+    PaidAccessResponse out;
+    ResponseParse r;
+    JsonParser p;
+    response_parse_init(&r, &paid_access_schema, client, &out, &client->allocator);
+    json_init(&p, &response_shape, &r);
+    if (json_feed(&p, doc, sizeof(doc) - 1) != 0 || json_finish(&p) != 0) {
+        fprintf(stderr, "paid-access document failed to parse\n");
+        failures++;
+        return;
+    }
+    if (!out.ok || !out.amount || strcmp(out.amount, "1") != 0 || out.decimals != 6 ||
+        strcmp(out.nonce, "first") != 0 || !out.status || strcmp(out.status, "settled") != 0 || out.tx[0]) {
+        fprintf(stderr, "paid access: ok %d amount %s decimals %d nonce %s status %s tx %s\n", out.ok,
+                out.amount ? out.amount : "(null)", out.decimals, out.nonce, out.status ? out.status : "(null)",
+                out.tx);
+        failures++;
+    }
+    nlx402_free_paid_access(&out);
+
+    static const char meta[] =
+        "{\"ok\":true,\"Supported_Mints\":[\"m1\",\"m2\"],\"supported_mints\":[\"m3\"],"
+        "\"metadata\":{\"network\":\"devnet\",\"Network\":\"mainnet\"}}";
+    MetadataResponse m;
+    response_parse_init(&r, &metadata_schema, client, &m, &client->allocator);
+    json_init(&p, &response_shape, &r);
+    if (json_feed(&p, meta, sizeof(meta) - 1) != 0 || json_finish(&p) != 0 || m.supported_mints_count != 2 ||
+        strcmp(m.supported_mints[1], "m2") != 0 || !m.network || strcmp(m.network, "devnet") != 0) {
+        fprintf(stderr, "metadata: %d mints, network %s\n", m.supported_mints_count, m.network ? m.network : "(null)");
+        failures++;
+    }
+    nlx402_free_metadata(&m);
+}
+
+int main(void) {
+    Nlx402Client client;
+    nlx402_client_init(&client, "http://127.0.0.1:1", "test-key");
+    Nlx402Handle h = { 0 };
+    h.allocator = &client.allocator;
+
+    test_malformed(&h);
+    test_escapes(&h);
+    test_long_tokens(&h);
+    test_response_keys(&client);
+
+    /* In real-time mode recv does not grow: a string that does not fit is a
+     * counted violation, not a silent truncation. */
+    atomic_ullong violations = 0;
+    Nlx402Handle fixed = { 0 };
+    fixed.allocator = &client.allocator;
+    fixed.rt_violations = &violations;
+    recv_reserve(&h, 1);
+    fixed.recv = h.recv;
+    fixed.recv_cap = 1024;
+    char doc[4096];
+    size_t n = (size_t)sprintf(doc, "{\"a\":\"");
+    memset(doc + n, 'x', 2000);
+    n += 2000;
+    n += (size_t)sprintf(doc + n, "\"}");
+    if (parse_split(&fixed, doc, n, 0, 0) == 0 || atomic_load(&violations) != 1) {
+        fprintf(stderr, "oversized string in real-time mode: %llu violations\n", (unsigned long long)violations);
+        failures++;
+    }
+
+    mem_free(h.allocator, h.recv);
+    nlx402_client_cleanup(&client);
+    printf("parser: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}
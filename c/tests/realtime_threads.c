@@ -0,0 +1,98 @@
+/* Real-time mode under concurrency: after one warm-up flow, several threads
+ * run quote, verify and paid-access flows and none of them may fail or be
+ * counted as a violation. libcurl allocates from the client's reserve during
+ * its requests, so a pool rejection anywhere, libcurl's included, fails the
+ * test too. A second, ordinary client runs flows alongside it on the shared
+ * pool, and the reserve holds nothing back once the client is cleaned up. */
+#include "../nlx402.c"
+#include "mock.h"
+
+#define THREADS 4
+#define FLOWS 50
+
+static Nlx402Client client;
+static Nlx402Client other;
+static atomic_int failures;
+
+static int run_flow_on(Nlx402Client *c) {
+    QuoteResponse quote;
+    VerifyResponse verify;
+    PaidAccessResponse paid;
+    if (nlx402_get_and_verify_quote(c, 0.5, &quote, &verify) != 0 || !verify.ok) return -1;
+    int rc = nlx402_get_paid_access(c, "5VERv8NMvzbJMEkV8xnrLkEaWRtSz9CosKDYjCJjBRnbJLgp8uirBgmQpjKhoR4tjF3ZpRzrFmBV6UjKdiSZkQUW",
+                                    quote.nonce, &paid);
+    if (rc == 0 && (!paid.ok || strcmp(paid.nonce, quote.nonce) != 0)) rc = -1;
+    if (rc == 0) nlx402_free_paid_access(&paid);
+    nlx402_free_quote(&quote);
+    return rc;
+}
+
+static int run_flow(void) {
+    return run_flow_on(&client);
+}
+
+static void *worker(void *arg) {
+    Nlx402Client *c = (Nlx402Client *)arg;
+    for (int i = 0; i < FLOWS; i++) {
+        if (run_flow_on(c) != 0) atomic_fetch_add(&failures, 1);
+    }
+    return NULL;
+}
+
+int main(void) {
+    MockServer mock = { 0 };
+    if (mock_start(&mock) != 0) {
+        fprintf(stderr, "mock server failed to start\n");
+        return 1;
+    }
+    nlx402_global_init_mem(CURL_GLOBAL_DEFAULT, nlx402_pool_allocator());
+    nlx402_client_init(&client, mock.url, "test-key");
+    nlx402_client_init(&other, mock.url, "test-key");
+
+    Nlx402RealtimeConfig rt = {
+        .handles = THREADS,
+        .recv_capacity = 8192,
+        .send_capacity = 4096,
+        .pool_blocks_per_class = 128,
+        .pool_max_block = 32 * 1024,
+        .intern_capacity = 32,
+        .lock_memory = 0,
+    };
+    if (nlx402_client_enable_realtime(&client, &rt) != 0 || run_flow() != 0) {
+        fprintf(stderr, "real-time setup or warm-up failed\n");
+        return 1;
+    }
+
+    pthread_t threads[THREADS + 1];
+    for (int i = 0; i < THREADS; i++) pthread_create(&threads[i], NULL, worker, &client);
+    pthread_create(&threads[THREADS], NULL, worker, &other);
+    for (int i = 0; i <= THREADS; i++) pthread_join(threads[i], NULL);
+
+    Nlx402PoolStats pool;
+    nlx402_pool_stats(&pool);
+    unsigned long long violations = nlx402_realtime_violations(&client);
+    printf("realtime_threads: %d threads x %d flows, %d failed, %llu violations, %llu pool rejections\n",
+           THREADS, FLOWS, atomic_load(&failures), violations, pool.rejected);
+
+    /* Only the real-time client is held to its reserve, and its misses are
+     * charged to it alone. */
+    void *big = mem_alloc(&other.allocator, NLX402_MEM_CACHES, 1 << 20);
+    int misattributed = !big || nlx402_realtime_violations(&client) != violations;
+    mem_free(&other.allocator, big);
+    misattributed |= mem_alloc(&client.allocator, NLX402_MEM_CACHES, 1 << 20) != NULL ||
+                     nlx402_realtime_violations(&client) != violations + 1;
+    if (misattributed) fprintf(stderr, "the reserve did not stay with the client that made it\n");
+
+    /* After cleanup the pool falls back to malloc again on this thread too. */
+    nlx402_client_cleanup(&client);
+    const Nlx402Allocator *pool_alloc = nlx402_pool_allocator();
+    void *after = pool_alloc->malloc_fn(pool_alloc->ctx, 1 << 20);
+    int stuck = !after;
+    pool_alloc->free_fn(pool_alloc->ctx, after);
+    stuck |= run_flow_on(&other) != 0;
+    if (stuck) fprintf(stderr, "the pool stayed reserved after cleanup\n");
+    nlx402_client_cleanup(&other);
+    curl_global_cleanup();
+    mock_stop(&mock);
+    return atomic_load(&failures) == 0 && violations == 0 && pool.rejected == 0 && !misattributed && !stuck ? 0 : 1;
+}
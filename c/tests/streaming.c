@@ -0,0 +1,81 @@
+/* A streamed body is parsed as it arrives, so a malformed one aborts the
+ * transfer at the first bad chunk instead of being read to the end. The
+ * mock sends the body in small chunks with a pause after each and counts
+ * how many went out. */
+#include "../nlx402.c"
+#include "mock.h"
+
+#define PADDING 4000
+#define CHUNK 16
+
+static int failures;
+
+static void expect(int ok, const char *what) {
+    if (!ok) {
+        fprintf(stderr, "%s\n", what);
+        failures++;
+    }
+}
+
+/* Sends prefix, PADDING spaces and "}"; returns the request's result and
+ * how many of the body's chunks went out. */
+static int request(MockServer *mock, Nlx402Client *client, const char *prefix, int *chunks, int *all) {
+    static char body[PADDING + 256];
+    size_t n = (size_t)snprintf(body, sizeof(body), "%s", prefix);
+    memset(body + n, ' ', PADDING);
+    memcpy(body + n + PADDING, "}", 2);
+    *all = (int)((n + PADDING + 1 + CHUNK - 1) / CHUNK);
+    mock->body = body;
+    atomic_store(&mock->chunks, 0);
+    MetadataResponse m;
+    int rc = nlx402_get_metadata(client, &m);
+    if (rc == 0) nlx402_free_metadata(&m);
+    *chunks = atomic_load(&mock->chunks);
+    return rc;
+}
+
+int main(void) {
+    MockServer mock = { 0 };
+    mock.chunk = CHUNK;
+    mock.pause_us = 500;
+    if (mock_start(&mock) != 0) {
+        fprintf(stderr, "mock server failed to start\n");
+        return 1;
+    }
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    Nlx402Client client;
+    nlx402_client_init(&client, mock.url, "test-key");
+    int chunks;
+    int all;
+
+    /* The same shape, well formed, is read to the end. */
+    expect(request(&mock, &client, "{\"ok\":true", &chunks, &all) == 0, "well-formed streamed body refused");
+    expect(chunks == all, "well-formed body was not sent whole");
+
+    /* Malformed in the first chunk, in a nested value, and after a long
+     * string; each must fail, and the streaming reader must stop early. */
+    static const char *const bad[] = {
+        "{\"ok\":nope",
+        "{\"ok\":true,\"metadata\":{\"network\":\"mainnet\",\"version\":]",
+        "{\"ok\":true,\"supported_mints\":[\"EPjFWdd5AufqSSqeM2qN1xzybapC8G4wEGGkZwyTDt1v\" \"x\"]",
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        expect(request(&mock, &client, bad[i], &chunks, &all) != 0, "malformed streamed body accepted");
+        if (JSON_STREAMING && chunks > all / 4) {
+            fprintf(stderr, "malformed body %zu: %d of %d chunks sent before the transfer stopped\n", i, chunks, all);
+            failures++;
+        }
+    }
+
+    /* The handle is still usable afterwards. */
+    mock.body = NULL;
+    MetadataResponse m;
+    expect(nlx402_get_metadata(&client, &m) == 0, "request after an aborted transfer failed");
+    nlx402_free_metadata(&m);
+
+    nlx402_client_cleanup(&client);
+    curl_global_cleanup();
+    mock_stop(&mock);
+    printf("streaming: %d failures\n", failures);
+    return failures == 0 ? 0 : 1;
+}